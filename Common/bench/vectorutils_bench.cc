@@ -0,0 +1,227 @@
+/**
+ * @file    vectorutils_bench.cc
+ * @brief   Micro-benchmarks of the duplicate removal and look up helpers
+ * @author  [Yi-Mu "Enoch" Chen](https://github.com/yimuchen)
+ *
+ * Comparing the ordered set, linear scan and hash table implementations of
+ * the duplicate removal, and the linear scan, usr::FlatSet and hash table
+ * look up of values, over a range of container sizes to locate the crossover
+ * points (see usr::base::linear_scan_max). The results are printed to standard
+ * output as one JSON object per line:
+ *
+ * ```
+ * {"bench":"removeduplicate_hash_int","size":16,"calls":1000,"ns_per_call":...,"calls_per_sec":...}
+ * ```
+ */
+#ifdef CMSSW_GIT_HASH
+#include "UserUtils/Common/interface/ArgumentExtender.hpp"
+#include "UserUtils/Common/interface/STLUtils/VectorUtils.hpp"
+#include "UserUtils/Common/interface/SystemUtils/Time.hpp"
+#else
+#include "UserUtils/Common/ArgumentExtender.hpp"
+#include "UserUtils/Common/STLUtils/VectorUtils.hpp"
+#include "UserUtils/Common/SystemUtils/Time.hpp"
+#endif
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/*-----------------------------------------------------------------------------
+ *  Reference implementations
+   --------------------------------------------------------------------------*/
+
+/**
+ * @brief Duplicate removal with an ordered set (the original implementation
+ * of usr::RemoveDuplicate).
+ */
+template<typename T>
+static std::vector<T>
+RemoveDuplicateOrdered( const std::vector<T>& dupvec )
+{
+  std::set<T>    unique_set;
+  std::vector<T> ans;
+
+  for( const auto& item : dupvec ){
+    if( unique_set.insert( item ).second ){
+      ans.push_back( item );
+    }
+  }
+
+  return ans;
+}
+
+
+/**
+ * @brief Duplicate removal with a linear scan of the output.
+ */
+template<typename T>
+static std::vector<T>
+RemoveDuplicateLinear( const std::vector<T>& dupvec )
+{
+  std::vector<T> ans;
+  ans.reserve( dupvec.size() );
+
+  for( const auto& item : dupvec ){
+    if( !usr::FindValue( ans, item ) ){
+      ans.push_back( item );
+    }
+  }
+
+  return ans;
+}
+
+
+/**
+ * @brief Duplicate removal with a hash table of the elements already seen.
+ */
+template<typename T>
+static std::vector<T>
+RemoveDuplicateHash( const std::vector<T>& dupvec )
+{
+  std::unordered_set<T> unique_set( dupvec.size() );
+  std::vector<T>        ans;
+  ans.reserve( dupvec.size() );
+
+  for( const auto& item : dupvec ){
+    if( unique_set.insert( item ).second ){
+      ans.push_back( item );
+    }
+  }
+
+  return ans;
+}
+
+
+/*-----------------------------------------------------------------------------
+ *  Benchmark sets
+   --------------------------------------------------------------------------*/
+
+/**
+ * @brief Running all benchmarks for a list of values with duplicates, and a
+ * list of query values, half of which are in the list.
+ */
+template<typename T>
+static void
+RunTypeBench( const std::string&                              tag,
+              const std::vector<T>&                           list,
+              const std::vector<T>&                           queries,
+              const unsigned                                  calls,
+              const std::function<void( const std::string&,
+                                        const unsigned,
+                                        const std::function<double()>& )>& Run )
+{
+  // The number of calls for the duplicate removal is scaled such that the
+  // total number of processed elements is independent of the list size.
+  const unsigned dupcalls = std::max( calls * 16 / unsigned( list.size() ), 1u );
+
+  Run( "removeduplicate_ordered_"+tag, dupcalls, [&]{
+    return RemoveDuplicateOrdered( list ).size();
+  } );
+  Run( "removeduplicate_linear_"+tag, dupcalls, [&]{
+    return RemoveDuplicateLinear( list ).size();
+  } );
+  Run( "removeduplicate_hash_"+tag, dupcalls, [&]{
+    return RemoveDuplicateHash( list ).size();
+  } );
+  Run( "removeduplicate_"+tag, dupcalls, [&]{
+    return usr::RemoveDuplicate( list ).size();
+  } );
+
+  // Look up of values in a unique list
+  const std::vector<T>        unique = usr::RemoveDuplicate( list );
+  const usr::FlatSet<T>       flat( unique );
+  const std::set<T>           ordered( unique.begin(), unique.end() );
+  const std::unordered_set<T> hashed( unique.begin(), unique.end() );
+  unsigned                    idx = 0;
+
+  Run( "lookup_vector_"+tag, calls, [&]{
+    idx = ( idx+1 ) % queries.size();
+    return size_t( usr::FindValue( unique, queries[idx] ) );
+  } );
+  Run( "lookup_flatset_"+tag, calls, [&]{
+    idx = ( idx+1 ) % queries.size();
+    return flat.count( queries[idx] );
+  } );
+  Run( "lookup_set_"+tag, calls, [&]{
+    idx = ( idx+1 ) % queries.size();
+    return ordered.count( queries[idx] );
+  } );
+  Run( "lookup_hash_"+tag, calls, [&]{
+    idx = ( idx+1 ) % queries.size();
+    return size_t( usr::FindValue( hashed, queries[idx] ) );
+  } );
+}
+
+
+/*-----------------------------------------------------------------------------
+ *  Main function
+   --------------------------------------------------------------------------*/
+int
+main( int argc, char** argv )
+{
+  usr::po::options_description desc( "Benchmark options" );
+  desc.add_options()
+    ( "size,s", usr::po::defmultivalue<unsigned>(
+      {4, 8, 16, 32, 64, 128, 256, 1024, 4096} ),
+    "List of container sizes to benchmark" )
+    ( "calls,n", usr::po::defvalue<unsigned>( 10000 ),
+    "Number of timed calls per look up benchmark (scaled by 16/size for the "
+    "duplicate removal benchmarks)" )
+    ( "seed", usr::po::defvalue<unsigned>( 42 ),
+    "Random seed for the synthetic inputs" )
+    ( "filter,f", usr::po::defvalue<std::string>( "" ),
+    "Only run benchmarks whose name contains this string" )
+  ;
+
+  usr::ArgumentExtender args;
+  args.AddOptions( desc );
+  args.ParseOptions( argc, argv );
+
+  const std::vector<unsigned> sizes = args.ArgList<unsigned>( "size" );
+  const unsigned              calls  = args.Arg<unsigned>( "calls" );
+  const unsigned              seed   = args.Arg<unsigned>( "seed" );
+  const std::string           filter = args.Arg<std::string>( "filter" );
+
+  std::mt19937 rand( seed );
+
+  for( const unsigned size : sizes ){
+    if( size == 0 ){ continue; }
+
+    auto Run = [&]( const std::string& name,
+                    const unsigned nc,
+                    const std::function<double()>& func ){
+                 if( name.find( filter ) != std::string::npos ){
+                   usr::RunBench( name, size, nc, func );
+                 }
+               };
+
+    // Lists with roughly half of the entries being duplicates, and query
+    // values with roughly half not being in the list.
+    std::uniform_int_distribution<int> list_dist( 0, size / 2 );
+    std::uniform_int_distribution<int> query_dist( 0, size );
+    std::vector<int>                   intlist( size );
+    std::vector<int>                   intquery( 1024 );
+    std::vector<std::string>           strlist( size );
+    std::vector<std::string>           strquery( 1024 );
+
+    for( unsigned i = 0; i < size; ++i ){
+      intlist[i] = list_dist( rand );
+      strlist[i] = "/path/to/file_"+std::to_string( intlist[i] )+".root";
+    }
+
+    for( unsigned i = 0; i < intquery.size(); ++i ){
+      intquery[i] = query_dist( rand );
+      strquery[i] = "/path/to/file_"+std::to_string( intquery[i] )+".root";
+    }
+
+    RunTypeBench<int>( "int", intlist, intquery, calls, Run );
+    RunTypeBench<std::string>( "string", strlist, strquery, calls, Run );
+  }
+
+  return 0;
+}
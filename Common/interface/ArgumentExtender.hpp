@@ -6,8 +6,11 @@
 #ifndef USERUTILS_COMMON_ARGUMENTEXTENDER_HPP
 #define USERUTILS_COMMON_ARGUMENTEXTENDER_HPP
 
+#include <atomic>
 #include <boost/program_options.hpp>
 #include <experimental/filesystem>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #ifdef CMSSW_GIT_HASH
@@ -99,6 +102,9 @@ public:
    * @brief template function for getting the extend object to an options.
    * @details The user is responsible for providing the correct string tag, and
    *          providing the correct type to case the data in the json file.
+   *          The extended values are looked up in a hash index built when the
+   *          json files are read. Implementations are available for the
+   *          `double`, `std::string` and `bool` types.
    */
   template<typename TYPE>
   TYPE ArgExt( const std::string& opt, const std::string& exttag ) const;
@@ -162,14 +168,27 @@ public:
   void PrintHelpAndExit() const;
 
 protected:
-  /** @brief Mutable access to internal property tree instance. */
-  inline JSONMap&NameMap(){ return _jsonmap; }
+  /**
+   * @brief Mutable access to internal property tree instance.
+   * @details The extended value index is regenerated on the next extended
+   * value look up.
+   */
+  inline JSONMap&
+  NameMap(){ _extdirty = true; return _jsonmap; }
 
-  /** @brief Mutable access to internal options description instance. */
-  inline po::options_description&Description(){ return _optdesc; }
+  /**
+   * @brief Mutable access to internal options description instance.
+   * @details The path strings are regenerated on the next path request.
+   */
+  inline po::options_description&
+  Description(){ _pathdirty = true; return _optdesc; }
 
-  /** @brief Mutable access to internal argument value map instance. */
-  inline po::variables_map&Args(){ return _argmap; }
+  /**
+   * @brief Mutable access to internal argument value map instance.
+   * @details The path strings are regenerated on the next path request.
+   */
+  inline po::variables_map&
+  Args(){ _pathdirty = true; return _argmap; }
 
 private:
   JSONDocument            _jsonmap;
@@ -180,8 +199,42 @@ private:
   PathScheme _dirscheme;
   PathScheme _namescheme;
 
+  // Results of GetPathPrefix and GetPathPostfix. Modifying the options, the
+  // parsed arguments or the naming schemes only marks the strings as dirty,
+  // they are regenerated by the first path request that follows.
+  mutable std::string _pathprefix;
+  mutable std::string _pathpostfix;
+
+  // Hash index of the member positions of the extended values in the json
+  // map: option -> option input -> extended value tag. The positions are
+  // verified against the member names on look up.
+  struct ExtInputIndex
+  {
+    size_t                                  pos;
+    std::unordered_map<std::string, size_t> tags;
+  };
+
+  struct ExtOptionIndex
+  {
+    size_t                                         pos;
+    std::unordered_map<std::string, ExtInputIndex> inputs;
+  };
+
+  mutable std::unordered_map<std::string, ExtOptionIndex> _extindex;
+
+  // Guarding the regeneration of the cached values in const methods.
+  mutable std::mutex        _cachelock;
+  mutable std::atomic<bool> _pathdirty = { true };
+  mutable std::atomic<bool> _extdirty  = { true };
+
   void        _init( const std::vector<std::string>& filelist );
   void        _check_parse_valid();
+  void        _update_path_cache() const;
+  void        _update_ext_index() const;
+  void        _build_ext_index() const;
+
+  const JSONMap& _ext_entry( const std::string& opt,
+                             const std::string& exttag ) const;
   std::string genPathString( const ArgPathScheme& ) const;
 
   // Helper functions for path generation.
@@ -8,6 +8,7 @@
 #define USERUTILS_COMMON_ROOTUTILS_ROOARGCONTAINER_HPP
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <RooCmdArg.h>
@@ -21,8 +22,10 @@ namespace usr
 class RooArgContainer : public std::vector<RooCmdArg>
 {
 public:
-  static std::vector<std::string> CustomCommandList;
-  static unsigned RegistorCommand( const std::string& );
+  static const std::vector<std::string>& CustomCommandList();
+  static std::vector<std::string>        CustomCommands();
+  static bool                            IsCustomCommand( const std::string& );
+  static unsigned                        RegistorCommand( const std::string& );
 
   RooArgContainer( const std::vector<RooCmdArg>& arg_list,
                    const std::vector<RooCmdArg>& default_list = {} );
@@ -42,6 +45,14 @@ public:
 
   RooLinkedList MakeRooList( const std::vector<std::string>& exclude = {} )
   const;
+
+private:
+  // Index of the command position by name generated at construction. Entries
+  // are verified against the container on look up, as the container can still
+  // be modified as a std::vector.
+  std::unordered_map<std::string, size_t> _index;
+
+  size_t Find( const std::string& name ) const;
 };
 
 }// namespace
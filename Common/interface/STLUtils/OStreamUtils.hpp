@@ -7,7 +7,10 @@
 #ifndef USERUTILS_COMMON_STLUTILS_OSTREAMUTILS_HPP
 #define USERUTILS_COMMON_STLUTILS_OSTREAMUTILS_HPP
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <mutex>
 
 #ifdef CMSSW_GIT_HASH
 #include "UserUtils/Common/interface/STLUtils/StringUtils.hpp"
@@ -59,6 +62,56 @@ void print_progress( const std::string& header,
                      const unsigned     total,
                      const unsigned     interval = 1 );
 
+/**
+ * @brief Progress reporting for loops that may be spread over many threads.
+ *
+ * Counts are accumulated with atomic operations, and the progress line
+ * (counts, percentage, throughput and estimated time remaining) is redrawn on
+ * STDERR at most once per refresh interval, by whichever thread happens to
+ * cross the interval. If STDERR is not a terminal, the progress is printed as
+ * plain lines at a slower rate (every 10 seconds or the refresh interval,
+ * whichever is longer), so that log files are not flooded. The final state is
+ * printed when Finish is called, or when the object is destroyed.
+ *
+ * ```c++
+ * usr::ProgressReporter progress( "Processing", nevents );
+ * usr::ParallelFor( nevents, 0, [&]( size_t i, unsigned ){
+ *   // ... work ...
+ *   progress.Add();
+ * } );
+ * progress.Finish();
+ * ```
+ */
+class ProgressReporter
+{
+public:
+  ProgressReporter( const std::string& header,
+                    const size_t       total,
+                    const double       refresh = 0.2 );
+  ~ProgressReporter();
+
+  void Add( const size_t n = 1 );
+  void Finish();
+
+  inline size_t Count() const { return _count.load(); }
+
+private:
+  typedef std::chrono::steady_clock clock;
+
+  std::string _header;
+  size_t _total;
+  int64_t _interval;// in nanoseconds
+  bool _istty;
+  bool _finished;
+  size_t _lastlength;
+  clock::time_point _start;
+  std::atomic<size_t> _count;
+  std::atomic<int64_t> _lastdraw;
+  std::mutex _drawmutex;
+
+  void Draw( const bool final );
+};
+
 /**
  * @brief Variadic interface for printf like stream output
  *
@@ -96,6 +149,32 @@ void PrintLog( const short        i,
                const std::string& line,
                const std::string& header = "" );
 
+/**
+ * @brief Setting the tag prepended to the logs of the calling thread.
+ */
+void SetThreadTag( const std::string& tag );
+
+/**
+ * @brief Adding a file to which the logs will also be written.
+ */
+void AddLogFile( const std::string& filename );
+
+/**
+ * @brief Removing all additional log files.
+ */
+void ClearLogFiles();
+
+/**
+ * @brief Whether logs should be written by a background thread (disabled by
+ * default).
+ */
+void SetLogAsync( const bool async );
+
+/**
+ * @brief Blocking until all pending logs have been written.
+ */
+void FlushLog();
+
 }/* log */
 
 /** @} */
@@ -8,6 +8,8 @@
 
 #include <boost/format.hpp>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace usr {
@@ -54,6 +56,92 @@ extern size_t NextOpenBrace( const std::string&, const unsigned start );
 extern bool starts_with( const std::string&, const std::string& );
 extern bool ends_with( const std::string&, const std::string& );
 
+/*-----------------------------------------------------------------------------
+ *  Helper objects for the fast formatting routine
+   --------------------------------------------------------------------------*/
+namespace fmt
+{
+
+namespace base
+{
+
+/**
+ * @brief Type-erased argument of the fast formatting routine used by
+ * usr::fstr.
+ */
+struct fstrarg
+{
+  enum argtype
+  {
+    SIGNED, UNSIGNED, FLOAT, STRING
+  };
+
+  argtype            type;
+  long long          i;
+  unsigned long long u;
+  double             d;
+  const char*        s;
+  size_t             n;
+};
+
+/**
+ * @brief Whether an argument type can be handled by the fast formatting
+ * routine. Characters and booleans are excluded as their stream output differs
+ * from their numerical value.
+ */
+template<typename T>
+struct fstr_fast_type
+{
+  static constexpr bool value =
+    ( std::is_integral<T>::value
+      && !std::is_same<T, bool>::value
+      && !std::is_same<T, char>::value
+      && !std::is_same<T, signed char>::value
+      && !std::is_same<T, unsigned char>::value
+      && !std::is_same<T, wchar_t>::value
+      && !std::is_same<T, char16_t>::value
+      && !std::is_same<T, char32_t>::value )
+    || std::is_same<T, float>::value
+    || std::is_same<T, double>::value
+    || std::is_same<T, std::string>::value
+    || std::is_same<T, std::string_view>::value
+    || std::is_same<T, const char*>::value
+    || std::is_same<T, char*>::value;
+};
+
+template<typename T>
+inline fstrarg
+MakeFstrArg( const T& x )
+{
+  fstrarg ans = {fstrarg::STRING, 0, 0, 0, nullptr, 0};
+  if constexpr( std::is_floating_point<T>::value ){
+    ans.type = fstrarg::FLOAT;
+    ans.d    = x;
+  } else if constexpr( std::is_integral<T>::value
+                       && std::is_signed<T>::value ){
+    ans.type = fstrarg::SIGNED;
+    ans.i    = x;
+  } else if constexpr( std::is_integral<T>::value ){
+    ans.type = fstrarg::UNSIGNED;
+    ans.u    = x;
+  } else {
+    const std::string_view v( x );
+    ans.s = v.data();
+    ans.n = v.size();
+  }
+  return ans;
+}
+
+
+extern bool fstr_fast( std::string&       ans,
+                       const std::string& fmt,
+                       const fstrarg*     args,
+                       const size_t       nargs );
+
+}/* base */
+
+}/* fmt */
+
 /**
  * @{
  * @brief Variadic interface for generating formmatted strings.
@@ -66,6 +154,11 @@ extern bool ends_with( const std::string&, const std::string& );
  * ```c++
  * std::cout << fstr("%d %d", myint, myunsigned ) << std::endl;
  * ```
+ *
+ * If all arguments are numbers or strings, and the format string only contains
+ * the common printf directives, the string is generated directly without
+ * going through boost::format (see usr::fmt::base::fstr_fast), with the same
+ * output. All other cases are passed to boost::format.
  */
 inline std::string
 fstr( boost::format& fmt )
@@ -82,6 +175,15 @@ template<typename ... ARGS>
 inline std::string
 fstr( const std::string& fmt, ARGS&& ... args )
 {
+  if constexpr( ( fmt::base::fstr_fast_type<std::decay_t<ARGS> >::value
+                  && ... ) ){
+    const fmt::base::fstrarg list[sizeof...( ARGS )+1] = {
+      fmt::base::MakeFstrArg( args ) ...};
+    std::string ans;
+    if( fmt::base::fstr_fast( ans, fmt, list, sizeof...( ARGS ) ) ){
+      return ans;
+    }
+  }
   boost::format f( fmt );
   return fstr( f, std::forward<ARGS>( args )... );
 }
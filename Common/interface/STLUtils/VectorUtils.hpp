@@ -7,10 +7,19 @@
 #ifndef USERUTILS_COMMON_STLUTILS_VECTORUTILS_HPP
 #define USERUTILS_COMMON_STLUTILS_VECTORUTILS_HPP
 #include <algorithm>
+#include <charconv>
 #include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <boost/algorithm/string.hpp>
@@ -31,11 +40,11 @@ namespace usr {
 template<typename T>
 std::vector<T> RemoveDuplicate( const std::vector<T>& dupvec );
 
-template<typename OBJTYPE, typename ARGTYPE, typename ... VARTYPE>
-std::vector<OBJTYPE> MakeVector( const ARGTYPE& first, const VARTYPE& ... arg );
+template<typename T, typename Compare = std::less<T> >
+class FlatSet;
 
-template<typename OBJTYPE, typename ARGTYPE>
-std::vector<OBJTYPE> MakeVector( const ARGTYPE& first );
+template<typename OBJTYPE, typename ... ARGTYPE>
+std::vector<OBJTYPE> MakeVector( const ARGTYPE& ... args );
 
 template<typename OBJTYPE>
 void ClearValue( std::vector<OBJTYPE>& vec, const OBJTYPE& x );
@@ -55,26 +64,204 @@ std::vector<OBJTYPE> ListFromFile( const std::string& file,
 /*-----------------------------------------------------------------------------
  *  Template Implementations
    --------------------------------------------------------------------------*/
+namespace base
+{
+
+/**
+ * @brief Type trait for whether a `std::hash` specialization is available for
+ * a type.
+ */
+template<typename T, typename = void>
+struct is_hashable : std::false_type {};
+
+template<typename T>
+struct is_hashable<T,
+                   std::void_t<decltype( std::hash<T>{}( std::declval<const T&>() ) )> >
+  : std::true_type {};
+
+/**
+ * @brief Container size below which a linear scan is faster than a hash table
+ * look up (see the vectorutils_bench program for the measurements).
+ */
+constexpr size_t linear_scan_max = 64;
+
+}/* base */
+
 /**
  * @brief Removing duplicates from a vector while maintaining vector order
  * regardless of whether the vector is sorted or not.
+ *
+ * Short vectors are deduplicated by a linear scan over the output, longer
+ * vectors of hashable types using a hash table of the elements already seen.
+ * Types without a `std::hash` specialization fall back to an ordered set.
  */
 template<typename T>
 std::vector<T>
 RemoveDuplicate( const std::vector<T>& dupvec )
 {
-  std::set<T> unique_set;
   std::vector<T> ans;
+  ans.reserve( dupvec.size() );
+
+  if constexpr ( base::is_hashable<T>::value ){
+    if( dupvec.size() <= base::linear_scan_max ){
+      for( const auto& item : dupvec ){
+        if( std::find( ans.begin(), ans.end(), item ) == ans.end() ){
+          ans.push_back( item );
+        }
+      }
+    } else {
+      std::unordered_set<T> unique_set( dupvec.size() );
 
-  for( const auto& item : dupvec ){
-    if( unique_set.insert( item ).second ){
-      ans.push_back( item );
+      for( const auto& item : dupvec ){
+        if( unique_set.insert( item ).second ){
+          ans.push_back( item );
+        }
+      }
+    }
+  } else {
+    std::set<T> unique_set;
+
+    for( const auto& item : dupvec ){
+      if( unique_set.insert( item ).second ){
+        ans.push_back( item );
+      }
     }
   }
 
   return ans;
 }
 
+/**
+ * @brief Set of unique values stored as a sorted vector.
+ *
+ * A drop-in replacement for `std::set` for the small sets typically used for
+ * membership tests in loops: look ups are binary searches over contiguous
+ * memory, and no per-element allocation is performed. Insertions and
+ * removals are linear in the size of the set, so `std::unordered_set` should
+ * be preferred for large sets that are modified frequently.
+ */
+template<typename T, typename Compare>
+class FlatSet
+{
+public:
+  typedef typename std::vector<T>::const_iterator const_iterator;
+  typedef const_iterator                          iterator;
+
+  FlatSet(){}
+
+  /** @brief Constructing from an arbitrary (unsorted) list of values. */
+  explicit FlatSet( std::vector<T> list ) : _data( std::move( list ) )
+  {
+    std::sort( _data.begin(), _data.end(), Compare() );
+    _data.erase( std::unique( _data.begin(), _data.end(),
+                              []( const T& x, const T& y ){
+      return !Compare()( x, y ) && !Compare()( y, x );
+    } ), _data.end() );
+  }
+
+  FlatSet( std::initializer_list<T> list ) :
+    FlatSet( std::vector<T>( list ) ){}
+
+  /**
+   * @brief Inserting a value, returning the position of the value and whether
+   * the insertion took place, following the `std::set::insert` convention.
+   */
+  std::pair<const_iterator, bool>
+  insert( const T& x )
+  {
+    auto it = std::lower_bound( _data.begin(), _data.end(), x, Compare() );
+    if( it != _data.end() && !Compare()( x, *it ) ){
+      return std::make_pair( const_iterator( it ), false );
+    }
+    it = _data.insert( it, x );
+    return std::make_pair( const_iterator( it ), true );
+  }
+
+  /** @brief Removing a value, returning the number of removed elements. */
+  size_t
+  erase( const T& x )
+  {
+    auto it = std::lower_bound( _data.begin(), _data.end(), x, Compare() );
+    if( it != _data.end() && !Compare()( x, *it ) ){
+      _data.erase( it );
+      return 1;
+    }
+    return 0;
+  }
+
+  const_iterator
+  find( const T& x ) const
+  {
+    auto it = std::lower_bound( _data.begin(), _data.end(), x, Compare() );
+    return ( it != _data.end() && !Compare()( x, *it ) ) ? it : _data.end();
+  }
+
+  inline size_t
+  count( const T& x ) const { return find( x ) != _data.end(); }
+
+  inline const_iterator
+  begin() const { return _data.begin(); }
+
+  inline const_iterator
+  end() const { return _data.end(); }
+
+  inline size_t
+  size() const { return _data.size(); }
+
+  inline bool
+  empty() const { return _data.empty(); }
+
+  inline void
+  reserve( const size_t n ){ _data.reserve( n ); }
+
+  inline void
+  clear(){ _data.clear(); }
+
+  /** @brief Constant access to the underlying sorted vector. */
+  inline const std::vector<T>&
+  Vector() const { return _data; }
+
+private:
+  std::vector<T> _data;
+};
+
+namespace base
+{
+
+/**
+ * @brief Number of elements an argument of usr::MakeVector contributes: 1 if
+ * the argument can be used to construct a single element, or the length of
+ * the argument if it is a container.
+ */
+template<typename OBJTYPE, typename ARGTYPE>
+size_t
+MakeVectorSize( const ARGTYPE& x )
+{
+  if constexpr ( std::is_constructible_v<OBJTYPE, const ARGTYPE&> ){
+    return 1;
+  } else {
+    return std::distance( std::begin( x ), std::end( x ) );
+  }
+}
+
+/**
+ * @brief Appending an argument of usr::MakeVector to the output vector.
+ */
+template<typename OBJTYPE, typename ARGTYPE>
+void
+MakeVectorAppend( std::vector<OBJTYPE>& ans, const ARGTYPE& x )
+{
+  if constexpr ( std::is_constructible_v<OBJTYPE, const ARGTYPE&> ){
+    ans.emplace_back( x );
+  } else {
+    for( const auto& item : x ){
+      ans.emplace_back( item );
+    }
+  }
+}
+
+}/* base */
+
 /**
  * @brief Constructing a vector of same-typed inputs of arbitrary number of
  *        function inputs
@@ -88,26 +275,22 @@ RemoveDuplicate( const std::vector<T>& dupvec )
  * allowing the user to input arbitrary many arguments for a given function,
  * particularly useful if your functions has many defaulted arguments that
  * the user might not want to keep track of ordering.
+ *
+ * Each argument that can be used to construct an `OBJTYPE` instance is added
+ * as a single element. Other arguments are treated as containers, and
+ * all their elements are added in order. The output is constructed with a
+ * single allocation.
  */
-template<typename OBJTYPE, typename ARGTYPE, typename ... VARTYPE>
+template<typename OBJTYPE, typename ... ARGTYPE>
 std::vector<OBJTYPE>
-MakeVector( const ARGTYPE& first, const VARTYPE& ... arg )
+MakeVector( const ARGTYPE& ... args )
 {
-  std::vector<OBJTYPE> ans = MakeVector<OBJTYPE>( arg ... );
-  ans.insert( ans.begin(), OBJTYPE( first ) );
+  std::vector<OBJTYPE> ans;
+  ans.reserve( ( size_t( 0 ) + ... + base::MakeVectorSize<OBJTYPE>( args ) ) );
+  ( base::MakeVectorAppend<OBJTYPE>( ans, args ), ... );
   return ans;
 }
 
-/**
- * @brief Starting point for the recursive call for the variadic interfaces.
- */
-template<typename OBJTYPE, typename ARGTYPE>
-std::vector<OBJTYPE>
-MakeVector( const ARGTYPE& first )
-{
-  return std::vector<OBJTYPE>( 1, OBJTYPE( first ) );
-}
-
 /**
  * @brief removing element in a vector if element is equivalent to x
  */
@@ -148,6 +331,31 @@ FindValue( std::vector<OBJTYPE>& vec, const OBJTYPE& x )
   return std::find( vec.begin(), vec.end(), x ) != vec.end();
 }
 
+/**
+ * @brief Checking if a value is in a usr::FlatSet, overload provided such that
+ * a lookup vector can be replaced with a usr::FlatSet without changing the
+ * calls.
+ */
+template<typename OBJTYPE, typename Compare>
+bool
+FindValue( const FlatSet<OBJTYPE, Compare>& set, const OBJTYPE& x )
+{
+  return set.count( x );
+}
+
+/**
+ * @brief Checking if a value is in a std::unordered_set, overload provided such
+ * that a lookup vector can be replaced with a hash table for long lists without
+ * changing the calls.
+ */
+template<typename OBJTYPE, typename Hash, typename KeyEqual, typename Alloc>
+bool
+FindValue( const std::unordered_set<OBJTYPE, Hash, KeyEqual, Alloc>& set,
+           const OBJTYPE&                                           x )
+{
+  return set.count( x );
+}
+
 /**
  * @brief Get the Maximum element value in a vector
  */
@@ -168,34 +376,127 @@ GetMinimum( const std::vector<OBJTYPE>& vec )
   return *std::min_element( vec.begin(), vec.end() );
 }
 
+namespace base
+{
+
+/**
+ * @brief Read-only view of the full contents of a file.
+ *
+ * Regular files are memory mapped, other files (pipes, character devices...)
+ * are read into an internal buffer. A file that cannot be opened results in
+ * an empty view.
+ */
+class FileView
+{
+public:
+  explicit FileView( const std::string& file );
+  ~FileView();
+  FileView( const FileView& ) = delete;
+  FileView& operator=( const FileView& ) = delete;
+
+  inline std::string_view
+  View() const { return std::string_view( _data, _size ); }
+
+private:
+  const char* _data;
+  size_t      _size;
+  void*       _map;
+  std::string _buffer;
+};
+
+/**
+ * @brief Converting a token of a file list to the requested type.
+ *
+ * Integer and floating point types are parsed using `std::from_chars`, strings
+ * are constructed directly from the token, everything else is passed to
+ * `boost::lexical_cast`. As with `boost::lexical_cast`, the full token must be
+ * consumed in the conversion, otherwise a `boost::bad_lexical_cast` exception
+ * is raised.
+ */
+template<typename OBJTYPE>
+OBJTYPE
+FromToken( std::string_view token )
+{
+  typedef std::decay_t<OBJTYPE> T;
+  constexpr bool is_int = std::is_integral_v<T>
+                          && !std::is_same_v<T, bool>
+                          && !std::is_same_v<T, char>
+                          && !std::is_same_v<T, signed char>
+                          && !std::is_same_v<T, unsigned char>;
+#if defined( __cpp_lib_to_chars )
+  constexpr bool is_float = std::is_floating_point_v<T>;
+#else
+  constexpr bool is_float = false;
+#endif
+
+  if constexpr ( std::is_same_v<T, std::string> ){
+    return std::string( token );
+  } else if constexpr ( is_int || is_float ){
+    // std::from_chars does not accept the leading '+' sign.
+    if( token.size() > 1 && token[0] == '+' && token[1] != '-' ){
+      token.remove_prefix( 1 );
+    }
+
+    // boost::lexical_cast accepts negative inputs for unsigned types by
+    // wrapping around the value.
+    bool negate = false;
+    if constexpr ( std::is_unsigned_v<T> ){
+      if( token.size() > 1 && token[0] == '-' && token[1] != '-'
+          && token[1] != '+' ){
+        negate = true;
+        token.remove_prefix( 1 );
+      }
+    }
+
+    T          ans {};
+    const auto end    = token.data()+token.size();
+    const auto result = std::from_chars( token.data(), end, ans );
+    if( result.ec != std::errc() || result.ptr != end ){
+      boost::throw_exception(
+        boost::bad_lexical_cast( typeid( std::string ), typeid( T ) ) );
+    }
+
+    return negate ? static_cast<T>( T( 0 )-ans ) : ans;
+  } else {
+    return boost::lexical_cast<T>( token.data(), token.size() );
+  }
+}
+
+}/* base */
+
 /**
  * @brief Getting a list of objects from a file.
  *
  * Given a file path, the function return the contents of file broken by
- * delimiters (be default the delimiter character is '\n').
+ * delimiters (be default the delimiter character is '\n'). Each character in
+ * the delimiter string is treated as a separate delimiter, and empty tokens
+ * are skipped. The file is memory mapped and each token is converted in place
+ * (see usr::base::FromToken), so the only allocations are those of the
+ * returned vector (and the strings in the case of a string list).
  */
 template<typename OBJTYPE>
 std::vector<OBJTYPE>
 ListFromFile( const std::string& file, const std::string& delimiter )
 {
-  std::ifstream f( file );
-  std::stringstream buffer;
-  std::string content;
-  std::vector<std::string> tokens;
-  std::vector<OBJTYPE> ans;
+  const base::FileView   content( file );
+  const std::string_view view = content.View();
+  std::vector<OBJTYPE>   ans;
 
-  // Getting the full contents of the file
-  buffer << f.rdbuf();
-  content = buffer.str();
+  bool isdelim[256] = {false};
 
-  // Boost algorithm for string splitting
-  boost::split( tokens, content, boost::is_any_of( delimiter ) );
+  for( const char c : delimiter ){
+    isdelim[static_cast<unsigned char>( c )] = true;
+  }
 
-  // std algorithm for removing empty strings.
-  tokens.erase( std::remove( tokens.begin(), tokens.end(), "" ), tokens.end() );
+  size_t begin = 0;
 
-  for( const auto& t : tokens ){
-    ans.push_back( boost::lexical_cast<OBJTYPE>( t ) );
+  for( size_t i = 0; i <= view.size(); ++i ){
+    if( i == view.size() || isdelim[static_cast<unsigned char>( view[i] )] ){
+      if( i > begin ){
+        ans.push_back( base::FromToken<OBJTYPE>( view.substr( begin, i-begin ) ) );
+      }
+      begin = i+1;
+    }
   }
 
   return ans;
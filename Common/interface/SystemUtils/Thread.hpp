@@ -0,0 +1,110 @@
+/**
+ * @file    Thread.hpp
+ * @brief   Simple worker pool for embarrassingly parallel loops.
+ * @author  [Yi-Mu "Enoch" Chen](https://github.com/yimuchen)
+ */
+
+#ifndef USERUTILS_COMMON_SYSTEMUTILS_THREAD_HPP
+#define USERUTILS_COMMON_SYSTEMUTILS_THREAD_HPP
+
+#ifdef CMSSW_GIT_HASH
+#include "UserUtils/Common/interface/SystemUtils/Command.hpp"
+#else
+#include "UserUtils/Common/SystemUtils/Command.hpp"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace usr {
+
+/**
+ * @defgroup SystemThread System Threads
+ * @brief    Minimal interface to std::thread for parallel loops.
+ * @ingroup  Common
+ * @{
+ */
+extern unsigned WorkerCount( const unsigned nthreads, const size_t njobs );
+
+template<typename FUNC>
+void ParallelFor( const size_t   njobs,
+                  const unsigned nthreads,
+                  FUNC&&         func );
+
+/** @} */
+
+/*-----------------------------------------------------------------------------
+ *  Template implementations
+   --------------------------------------------------------------------------*/
+
+/**
+ * @brief Running `func( job, worker )` for every job index in [0, njobs) on a
+ * pool of worker threads.
+ *
+ * Jobs are dispatched dynamically to the next free worker, so the mapping of
+ * jobs to workers is not deterministic. Any results that should be
+ * reproducible should therefore be stored by the job index (and any random
+ * seeds derived from the job index), while the worker index should only be
+ * used for selecting worker-owned resources (cloned objects, buffers... etc).
+ * The number of workers is determined by the WorkerCount function.
+ *
+ * The first exception raised by any of the jobs is re-thrown in the calling
+ * thread after all workers have stopped. Remaining jobs will not be started
+ * once an exception has been raised.
+ */
+template<typename FUNC>
+void
+ParallelFor( const size_t njobs, const unsigned nthreads, FUNC&& func )
+{
+  const unsigned nworkers = WorkerCount( nthreads, njobs );
+
+  if( nworkers <= 1 ){
+    for( size_t job = 0; job < njobs; ++job ){
+      func( job, 0u );
+    }
+
+    return;
+  }
+
+  std::atomic<size_t> next( 0 );
+  std::atomic<bool>   failed( false );
+  std::exception_ptr  error;
+  std::mutex          error_lock;
+
+  auto work = [&]( const unsigned worker ){
+                for( size_t job = next++; job < njobs && !failed; job = next++ ){
+                  try {
+                    func( job, worker );
+                  } catch( ... ){
+                    std::lock_guard<std::mutex> lock( error_lock );
+                    if( !failed.exchange( true ) ){
+                      error = std::current_exception();
+                    }
+                  }
+                }
+              };
+
+  std::vector<std::thread> pool;
+
+  for( unsigned worker = 1; worker < nworkers; ++worker ){
+    pool.emplace_back( work, worker );
+  }
+
+  work( 0 );
+
+  for( auto& thread : pool ){
+    thread.join();
+  }
+
+  if( error ){
+    std::rethrow_exception( error );
+  }
+}
+
+}/* usr */
+
+#endif/* end of include guard: USERUTILS_COMMON_SYSTEMUTILS_THREAD_HPP */
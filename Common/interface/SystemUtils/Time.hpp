@@ -5,6 +5,7 @@
 #ifndef USERUTILS_COMMON_SYSTEMUTILS_TIMP_HPP
 #define USERUTILS_COMMON_SYSTEMUTILS_TIMP_HPP
 
+#include <functional>
 #include <string>
 
 namespace usr {
@@ -35,6 +36,14 @@ extern void SleepMicroSec( const unsigned );
 extern void SleepMillSec( const unsigned );
 extern void SleepSec( const unsigned );
 
+/*-----------------------------------------------------------------------------
+ *  Timing functions for benchmark programs
+   --------------------------------------------------------------------------*/
+extern void RunBench( const std::string&             name,
+                      const unsigned                 size,
+                      const unsigned                 calls,
+                      const std::function<double()>& func );
+
 /* @} */
 
 } /* usr */
@@ -13,7 +13,6 @@
 #include "UserUtils/Common/STLUtils/StringUtils.hpp"
 #endif
 
-#include <boost/algorithm/string.hpp>
 #include <boost/exception/diagnostic_information.hpp>
 #include <boost/foreach.hpp>
 #include <boost/program_options/errors.hpp>
@@ -30,6 +29,10 @@ namespace fs  = std::experimental::filesystem;
 namespace usr
 {
 
+static const JSONMap* FindExtMember( const JSONMap&,
+                                     const std::string&,
+                                     const size_t* );
+
 /**
  * @brief Construction of the class property tree with a list of files.
  *
@@ -48,69 +51,69 @@ void
 ArgumentExtender::_init( const std::vector<std::string>& filelist )
 {
   _jsonmap = FromJSONFiles( filelist );
+  _update_ext_index();
 
   for( const auto& member : _jsonmap.GetObject() ){
-    const std::string optname = member.name.GetString();
-    if( !member.value.IsObject() ){
-      std::cerr << "Bad format for option [" << optname << "]" << std::endl;
-      throw std::invalid_argument( optname );
-    }
+    const std::string     optname     = member.name.GetString();
+    const ExtOptionIndex& optionindex = _extindex.at( optname );
 
     std::vector<std::string> exttaglist;
 
     for( const auto& submember : member.value.GetObject() ){
-      const std::string optval = submember.name.GetString();
-      if( !submember.value.IsObject() ){
-        std::cerr << "Bad format for option [" << optname << "] " <<
-          "with value [" << optval << "]" << std::endl;
-        throw std::invalid_argument( optval );
-      }
-
-      std::vector<std::string> this_exttaglist;
-
-      for( const auto& leaf : submember.value.GetObject() ){
-        this_exttaglist.push_back( leaf.name.GetString() );
-      }
+      const std::string optval   = submember.name.GetString();
+      const auto&       tagindex = optionindex.inputs.at( optval ).tags;
 
-      std::sort( this_exttaglist.begin(), this_exttaglist.end() );
-
-      if( this_exttaglist.size() == 0 ){
+      if( tagindex.size() == 0 ){
         std::cerr << "No extended values for option [" << optname << "] " <<
           "with value [" << optval << "]" << std::endl;
         throw std::invalid_argument( optval );
       }
 
       if( exttaglist.size() == 0 ){
-        exttaglist = this_exttaglist;
+        for( const auto& tag : tagindex ){
+          exttaglist.push_back( tag.first );
+        }
+
+        std::sort( exttaglist.begin(), exttaglist.end() );
         continue;
       }
 
-      if( exttaglist.size() > this_exttaglist.size() ){
+      // Inputs are allowed to define additional extended values, but all
+      // values defined for the first input must be present.
+      if( exttaglist.size() > tagindex.size() ){
         for( const auto& tag : exttaglist ){
-          if( !FindValue( this_exttaglist, tag ) ){
+          if( !tagindex.count( tag ) ){
             std::cerr << "Missing extended value [" << tag << "] " <<
               "for option [" << optname << "] " << "with value [" << optval <<
               "]" << std::endl;
             throw std::invalid_argument( tag );
           }
         }
-      } else if( exttaglist.size() < this_exttaglist.size() ){
-        for( const auto& tag : this_exttaglist ){
-          if( !FindValue( this_exttaglist, tag ) ){
-            std::cerr << "Missing extended value [" << tag << "] " <<
-              "for option [" << optname << "] " << "with value [" << optval <<
-              "]" << std::endl;
-            throw std::invalid_argument( tag );
-          }
+      } else if( exttaglist.size() == tagindex.size() ){
+        bool match = true;
+
+        for( const auto& tag : exttaglist ){
+          match = match && tagindex.count( tag );
         }
-      } else {
-        for( size_t i = 0; i < exttaglist.size(); ++i ){
-          if( exttaglist.at( i ) != this_exttaglist.at( i ) ){
-            const std::string misval = exttaglist.at( i );
-            std::cerr << "Undefined extended value [" << misval << "] " <<
-              "for option [" << optname << "] " << "with value [" << optval <<
-              "]" << std::endl;
-            throw std::invalid_argument( misval );
+
+        if( !match ){
+          // Reporting the first mismatch in the sorted lists of tags.
+          std::vector<std::string> this_exttaglist;
+
+          for( const auto& tag : tagindex ){
+            this_exttaglist.push_back( tag.first );
+          }
+
+          std::sort( this_exttaglist.begin(), this_exttaglist.end() );
+
+          for( size_t i = 0; i < exttaglist.size(); ++i ){
+            if( exttaglist.at( i ) != this_exttaglist.at( i ) ){
+              const std::string misval = exttaglist.at( i );
+              std::cerr << "Undefined extended value [" << misval << "] " <<
+                "for option [" << optname << "] " << "with value [" <<
+                optval << "]" << std::endl;
+              throw std::invalid_argument( misval );
+            }
           }
         }
       }
@@ -267,9 +270,7 @@ ArgumentExtender::_check_parse_valid()
       BOOST_THROW_EXCEPTION( po::required_option( optname ) );
     }
 
-    std::vector<std::string> validoptionlist;
-    if( !member.value.GetObject().HasMember( Arg<std::string>( optname ).c_str() ) )
-    {
+    if( !FindExtMember( member.value, Arg<std::string>( optname ), nullptr ) ){
       std::cerr << usr::fstr(
         "Extended values for options for [%s] with value [%s] is not defined!\n",
         optname,
@@ -297,6 +298,183 @@ ArgumentExtender::_check_parse_valid()
 }
 
 
+/**
+ * @brief Regenerating the extended value index if the json map was accessed
+ * via the mutable accessor since the last regeneration.
+ */
+void
+ArgumentExtender::_update_ext_index() const
+{
+  if( !_extdirty ){ return; }
+
+  std::lock_guard<std::mutex> lock( _cachelock );
+  if( !_extdirty ){ return; }
+  _build_ext_index();
+  _extdirty = false;
+}
+
+
+/**
+ * @brief Building the hash index of the extended values from the json map.
+ *
+ * Raises an exception if the json map is not of the format
+ * `{ option: { input: { tag: value, ... }, ... }, ... }`. If an input or a tag
+ * is defined multiple times, only the first instance is indexed, consistent
+ * with the member look up of rapidjson. Only the positions of the json members
+ * are stored, so the index never refers to json values that no longer exist.
+ */
+void
+ArgumentExtender::_build_ext_index() const
+{
+  _extindex.clear();
+
+  size_t optpos = 0;
+
+  for( const auto& member : _jsonmap.GetObject() ){
+    const std::string optname = member.name.GetString();
+    if( !member.value.IsObject() ){
+      std::cerr << "Bad format for option [" << optname << "]" << std::endl;
+      throw std::invalid_argument( optname );
+    }
+
+    ExtOptionIndex& optionindex = _extindex[optname];
+    optionindex.pos = optpos++;
+    optionindex.inputs.reserve( member.value.MemberCount() );
+
+    size_t inputpos = 0;
+
+    for( const auto& submember : member.value.GetObject() ){
+      const std::string optval  = submember.name.GetString();
+      const size_t      thispos = inputpos++;
+      if( !submember.value.IsObject() ){
+        std::cerr << "Bad format for option [" << optname << "] " <<
+          "with value [" << optval << "]" << std::endl;
+        throw std::invalid_argument( optval );
+      }
+
+      if( optionindex.inputs.count( optval ) ){ continue; }
+
+      ExtInputIndex& inputindex = optionindex.inputs[optval];
+      inputindex.pos = thispos;
+      inputindex.tags.reserve( submember.value.MemberCount() );
+
+      size_t tagpos = 0;
+
+      for( const auto& leaf : submember.value.GetObject() ){
+        inputindex.tags.emplace( leaf.name.GetString(), tagpos++ );
+      }
+    }
+  }
+}
+
+
+/**
+ * @brief Finding the member of a json object by name, returning nullptr if
+ * not found.
+ *
+ * If a position is given by the index, the member at that position is used if
+ * it still has the requested name, otherwise (or if the json map was modified
+ * such that the position is no longer valid) the object is searched directly.
+ */
+static const JSONMap*
+FindExtMember( const JSONMap& obj, const std::string& name, const size_t* pos )
+{
+  if( !obj.IsObject() ){ return nullptr; }
+
+  if( pos && *pos < obj.MemberCount() ){
+    const auto iter = obj.MemberBegin()+*pos;
+    if( name == iter->name.GetString() ){ return &iter->value; }
+  }
+
+  const auto iter = obj.FindMember( name.c_str() );
+  return iter == obj.MemberEnd() ? nullptr : &iter->value;
+}
+
+
+/**
+ * @brief Getting the json value of an extended tag for the current input of an
+ * option.
+ *
+ * Raises an exception if the option is not defined in the json map, or if the
+ * extended tag is not defined for the input value.
+ */
+const JSONMap&
+ArgumentExtender::_ext_entry( const std::string& opt,
+                              const std::string& exttag ) const
+{
+  const ExtOptionIndex* optindex   = nullptr;
+  const ExtInputIndex*  inputindex = nullptr;
+  const size_t*         tagpos     = nullptr;
+
+  _update_ext_index();
+
+  const auto optit = _extindex.find( opt );
+  if( optit != _extindex.end() ){ optindex = &optit->second; }
+
+  const JSONMap* optmap = FindExtMember( _jsonmap, opt,
+                                         optindex ? &optindex->pos : nullptr );
+  if( !optmap ){
+    throw std::invalid_argument(
+            usr::fstr( "Option [%s] does not have extended values defined",
+                       opt ) );
+  }
+
+  const std::string optval = Arg<std::string>( opt );
+  if( optindex ){
+    const auto inputit = optindex->inputs.find( optval );
+    if( inputit != optindex->inputs.end() ){ inputindex = &inputit->second; }
+  }
+
+  const JSONMap* inputmap = FindExtMember(
+    *optmap, optval, inputindex ? &inputindex->pos : nullptr );
+  if( !inputmap ){
+    throw std::invalid_argument(
+            usr::fstr( "Extended values for options for [%s] with value [%s] "
+                       "is not defined!", opt, optval ) );
+  }
+
+  if( inputindex ){
+    const auto tagit = inputindex->tags.find( exttag );
+    if( tagit != inputindex->tags.end() ){ tagpos = &tagit->second; }
+  }
+
+  const JSONMap* val = FindExtMember( *inputmap, exttag, tagpos );
+  if( !val ){
+    throw std::invalid_argument(
+            usr::fstr( "Undefined extended value [%s] for option [%s] "
+                       "with value [%s]", exttag, opt, optval ) );
+  }
+
+  return *val;
+}
+
+
+// ------------------------------------------------------------------------------
+#define MAKE_CONCRETE_ARGEXT( TYPE, IS_FUNCTION, GET_FUNCTION )                 \
+  template<>                                                                    \
+  TYPE                                                                          \
+  ArgumentExtender::ArgExt<TYPE>( const std::string& opt,                       \
+                                  const std::string& exttag ) const             \
+  {                                                                             \
+    const JSONMap& val = _ext_entry( opt, exttag );                             \
+    if( !val.IS_FUNCTION() ){                                                   \
+      throw std::invalid_argument(                                              \
+              usr::fstr( "Extended value [%s] for option [%s] is invalid type " \
+                         "(expected %s)",                                       \
+                         exttag,                                                \
+                         opt,                                                   \
+                         #TYPE  ) );                                            \
+    }                                                                           \
+    return val.GET_FUNCTION();                                                  \
+  }
+
+MAKE_CONCRETE_ARGEXT( double,      IsNumber, GetDouble );
+MAKE_CONCRETE_ARGEXT( std::string, IsString, GetString );
+MAKE_CONCRETE_ARGEXT( bool,        IsBool,   GetBool   );
+
+#undef MAKE_CONCRETE_ARGEXT
+
+
 /**
  * @brief Printing help message of arguments and exit the program.
  */
@@ -328,6 +506,7 @@ void
 ArgumentExtender::SetFilePrefix( const fs::path pre )
 {
   _prefix = pre;
+  _pathdirty = true;
 }
 
 
@@ -340,6 +519,7 @@ void
 ArgumentExtender::SetDirScheme( const PathScheme& newscheme )
 {
   _dirscheme = newscheme;
+  _pathdirty = true;
 }
 
 
@@ -350,6 +530,7 @@ void
 ArgumentExtender::AddDirScheme( const ArgPathScheme& arg )
 {
   _dirscheme.push_back( arg );
+  _pathdirty = true;
 }
 
 
@@ -364,6 +545,8 @@ ArgumentExtender::AddDirScheme( const PathScheme& newscheme )
   for( const auto& x : newscheme ){
     _dirscheme.push_back( x );
   }
+
+  _pathdirty = true;
 }
 
 
@@ -376,6 +559,7 @@ void
 ArgumentExtender::SetNameScheme( const PathScheme& newscheme )
 {
   _namescheme = newscheme;
+  _pathdirty = true;
 }
 
 
@@ -386,6 +570,7 @@ void
 ArgumentExtender::AddNameScheme( const ArgPathScheme& arg )
 {
   _namescheme.push_back( arg );
+  _pathdirty = true;
 }
 
 
@@ -400,6 +585,8 @@ ArgumentExtender::AddNameScheme( const PathScheme& newscheme )
   for( const auto& x : newscheme ){
     _namescheme.push_back( x );
   }
+
+  _pathdirty = true;
 }
 
 
@@ -411,17 +598,34 @@ ArgumentExtender::AddNameScheme( const PathScheme& newscheme )
  * file. The character separating the option inputs values will simply be '_'.
  *
  * For details on the generation of individual options string, see the private
- * method `genPathString()`.
+ * method `genPathString()`. The directory and the postfix strings are cached
+ * (see `_update_path_cache()`), so the path is generated by a single string
+ * concatenation.
  */
 fs::path
 ArgumentExtender::MakeFile( const std::string& nameprefix,
                             const std::string& ext ) const
 {
-  fs::path ans = GetPathPrefix();
-  ans /= ( nameprefix+GetPathPostfix() );
-  ans += "."+ext;
-
-  return ans;
+  _update_path_cache();
+
+  std::string ans;
+  ans.reserve( _pathprefix.size()+nameprefix.size()+_pathpostfix.size()
+               +ext.size()+2 );
+  ans += _pathprefix;
+
+  // Same separator rules as fs::path::operator/=
+  const bool addsep = !_pathprefix.empty() && _pathprefix.back() != '/'
+                      && ( nameprefix.empty() ?
+                           !_pathpostfix.empty() && _pathpostfix[0] != '/' :
+                           nameprefix[0] != '/' );
+  if( addsep ){ ans += '/'; }
+
+  ans += nameprefix;
+  ans += _pathpostfix;
+  ans += '.';
+  ans += ext;
+
+  return fs::path( ans );
 }
 
 
@@ -456,29 +660,54 @@ ArgumentExtender::MakeTEXFile( const std::string& x ) const
 std::string
 ArgumentExtender::GetPathPrefix() const
 {
-  fs::path dirname = _prefix;
-
-  for( const auto& x : _dirscheme ){
-    dirname /= genPathString( x );
-  }
-
-  return dirname.string();
+  _update_path_cache();
+  return _pathprefix;
 }
 
 
 std::string
 ArgumentExtender::GetPathPostfix() const
 {
-  std::string ans = "";
+  _update_path_cache();
+  return _pathpostfix;
+}
+
+
+/**
+ * @brief Regenerating the cached directory and postfix strings.
+ *
+ * The naming scheme setters and the mutable accessors of the options
+ * description and the parsed arguments only mark the cached strings as dirty,
+ * so the option inputs are only converted to strings once per change rather
+ * than once per requested file, regardless of how the instance was modified.
+ * The regeneration is guarded such that concurrent const calls are safe.
+ */
+void
+ArgumentExtender::_update_path_cache() const
+{
+  if( !_pathdirty ){ return; }
+
+  std::lock_guard<std::mutex> lock( _cachelock );
+  if( !_pathdirty ){ return; }
+
+  fs::path dirname = _prefix;
+
+  for( const auto& x : _dirscheme ){
+    dirname /= genPathString( x );
+  }
+
+  _pathprefix = dirname.string();
+  _pathpostfix.clear();
 
   for( const auto& x : _namescheme ){
     const std::string str = genPathString( x );
     if( str != "" ){
-      ans += "_"+genPathString( x );
+      _pathpostfix += '_';
+      _pathpostfix += str;
     }
   }
 
-  return ans;
+  _pathdirty = false;
 }
 
 
@@ -513,8 +742,13 @@ ArgumentExtender::genPathString( const ArgPathScheme& x ) const
     inputstring = genPathString_Single( x );
   }
 
-  boost::replace_all( inputstring, ".", "p" );
-  boost::replace_all( inputstring, " ", "-" );
+  for( auto& c : inputstring ){
+    if( c == '.' ){
+      c = 'p';
+    } else if( c == ' ' ){
+      c = '-';
+    }
+  }
 
   return inputstring;
 }
@@ -14,8 +14,10 @@
 #include "UserUtils/Common/STLUtils/StringUtils.hpp"
 #endif
 
-#include <boost/algorithm/string.hpp>
+#include <charconv>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <regex>
 #include <string>
 
@@ -59,44 +61,152 @@ std::string spacestr_default = "";
  */
 const unsigned max_precision = 27;
 
+/*-----------------------------------------------------------------------------
+ *  Helper functions for the string generation
+   --------------------------------------------------------------------------*/
+
+/**
+ * @brief Writing the fixed-point representation of a double with a given
+ * number of digits after the decimal point into a buffer, returning the
+ * number of characters written.
+ *
+ * The output is identical to that of the printf "%.<p>f" format. The largest
+ * double is around e308, so a buffer of 512 is enough with the limit on the
+ * precision.
+ */
+static size_t
+FormatFixed( char* buf, const size_t size, const double x, const unsigned p )
+{
+#if defined( __cpp_lib_to_chars )
+  const auto res = std::to_chars( buf, buf+size, x,
+                                  std::chars_format::fixed, (int)p );
+  return res.ptr-buf;
+#else
+  return std::snprintf( buf, size, "%.*f", (int)p, x );
+#endif
+}
+
+
+/**
+ * @brief Inserting the separator string every `sep` digits away from the
+ * decimal point (or the right most digit if the decimal point doesn't exist).
+ *
+ * This is the original regular expression implementation of the digit
+ * grouping, used only when the separator string itself contains characters
+ * that would interfere with the patterns (digits, the decimal point, or the
+ * characters special to regex replacement strings), so that the output is the
+ * same for all separator strings.
+ */
+static std::string
+GroupDigitsRegex( std::string        retstr,
+                  const unsigned     sep,
+                  const std::string& spacestr )
+{
+  // Largest double is around e308
+  int space = ( ( (int)( retstr.length() / sep ) )+1 ) * sep;
+
+  while( space > 0 ){
+    if( retstr.find( '.' ) != std::string::npos ){
+      // If decimal point exists, expand around decimal point
+      const std::regex before( usr::fstr( "(.*\\d)(\\d{%d}\\..*)", space ) );
+      const std::regex after(  usr::fstr( "(.*\\.\\d{%d})(\\d.*)", space ) );
+      retstr = std::regex_replace( retstr, before, "$1"+spacestr+"$2" );
+      retstr = std::regex_replace( retstr, after,  "$1"+spacestr+"$2" );
+    } else {
+      // If decimal point doesn't exist, expand around right most side
+      const std::regex beforedec(  usr::fstr( "(.*\\d)(\\d{%d})", space ) );
+      retstr = std::regex_replace( retstr, beforedec, "$1"+spacestr+"$2" );
+    }
+    space -= sep;
+  }
+
+  return retstr;
+}
+
+
+/**
+ * @brief Inserting the separator string every `sep` digits away from the
+ * decimal point, with a single pass over the string.
+ */
+static std::string
+GroupDigits( const std::string& str,
+             const unsigned     sep,
+             const std::string& spacestr )
+{
+  static const char digits[] = "0123456789";
+  if( spacestr.find_first_of( ".$\n\r0123456789" ) != std::string::npos ){
+    return GroupDigitsRegex( str, sep, spacestr );
+  }
+
+  const size_t begin = str.find_first_of( digits );
+  if( begin == std::string::npos ){// inf or nan
+    return str;
+  }
+
+  const size_t dot    = str.find( '.', begin );
+  const size_t intend = dot == std::string::npos ? str.length() : dot;
+  if( str.find_first_not_of( digits, begin ) != intend ||
+      ( dot != std::string::npos &&
+        str.find_first_not_of( digits, dot+1 ) != std::string::npos ) ){
+    return GroupDigitsRegex( str, sep, spacestr );
+  }
+
+  const size_t nfrac = dot == std::string::npos ? 0 : str.length()-dot-1;
+  std::string  ans;
+  ans.reserve( str.length()
+               +( ( intend-begin ) / sep+nfrac / sep+1 ) * spacestr.length() );
+  ans.append( str, 0, begin );
+
+  for( size_t i = begin; i < intend; ++i ){
+    if( i != begin && ( intend-i ) % sep == 0 ){
+      ans += spacestr;
+    }
+    ans += str[i];
+  }
+
+  if( dot != std::string::npos ){
+    ans += '.';
+
+    for( size_t i = 0; i < nfrac; ++i ){
+      if( i != 0 && i % sep == 0 ){
+        ans += spacestr;
+      }
+      ans += str[dot+1+i];
+    }
+  }
+
+  return ans;
+}
+
+
 /**
  * @brief generating string to represent double as a string in decimal.
  */
 std::string
 decimal::str() const
 {
-  const unsigned op_precision = std::min( abs( _precision ),
-                                          abs(
-                                            max_precision ) );
-  std::string retstr = usr::fstr( usr::fstr( "%%.%df", op_precision ), _input );
+  const unsigned op_precision = std::min( (unsigned)abs( _precision ),
+                                          max_precision );
+  char   buf[512];
+  size_t len = FormatFixed( buf, sizeof( buf ), _input, op_precision );
 
   // stripping trailing zero after decimal point
-  if( _precision < 0 && retstr.find( '.' ) != std::string::npos ){
-    boost::trim_right_if( retstr, boost::is_any_of( "0" ) );
-    boost::trim_right_if( retstr, boost::is_any_of( "." ) );
+  if( _precision < 0 && std::memchr( buf, '.', len ) != nullptr ){
+    while( len > 0 && buf[len-1] == '0' ){
+      --len;
+    }
+
+    while( len > 0 && buf[len-1] == '.' ){
+      --len;
+    }
   }
 
   // Adding spacing string every _spacesep digits away from decimal point
-  // Largest double is around e308
   if( _spacesep != 0 && _spacestr != "" ){
-    int space = ( ( (int)( retstr.length() / _spacesep ) )+1 ) * _spacesep;
-
-    while( space > 0 ){
-      if( retstr.find( '.' ) != std::string::npos ){
-        // If decimal point exists, expand around decimal point
-        const std::regex before( usr::fstr( "(.*\\d)(\\d{%d}\\..*)", space ) );
-        const std::regex after(  usr::fstr( "(.*\\.\\d{%d})(\\d.*)", space ) );
-        retstr = std::regex_replace( retstr, before, "$1"+_spacestr+"$2" );
-        retstr = std::regex_replace( retstr, after,  "$1"+_spacestr+"$2" );
-      } else {
-        // If decimal point doesn't exist, expand around right most side
-        const std::regex beforedec(  usr::fstr( "(.*\\d)(\\d{%d})", space ) );
-        retstr = std::regex_replace( retstr, beforedec, "$1"+_spacestr+"$2" );
-      }
-      space -= _spacesep;
-    }
+    return GroupDigits( std::string( buf, len ), _spacesep, _spacestr );
+  } else {
+    return std::string( buf, len );
   }
-  return retstr;
 }
 
 
@@ -125,7 +235,7 @@ scientific::str() const
   // no need of additional formatting.
   const std::string ans = ( _exp == 0 ) ?
                           base :
-                          usr::fstr( "%s \\times 10^{%d}", base, _exp );
+                          base+" \\times 10^{"+std::to_string( _exp )+"}";
   return ans;
 }
 
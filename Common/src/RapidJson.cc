@@ -6,9 +6,12 @@
 #include "UserUtils/Common/STLUtils/StringUtils.hpp"
 #endif
 
-#include <fstream>
-#include <sstream>
+#include "rapidjson/filereadstream.h"
+
+#include <cstdio>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace usr
 {
@@ -79,21 +82,31 @@ namespace usr
 
 
 /**
- * @brief Getting a json document from a single input files
+ * @brief Parsing a JSON file into an existing document, throwing an exception
+ * if the parsing fails.
  *
- * This function is basically a wrap for using the standard
- * `rapidjson::Document::Parse` function, for using a C++ string to identify the
- * file to open.
+ * The file is parsed directly from a `rapidjson::FileReadStream` with a
+ * fixed-size (thread-local) read buffer, so the file contents are never copied
+ * into memory as a whole. A file that cannot be opened is treated as an empty
+ * document.
  */
-JSONDocument
-FromJSONFile( const std::string& filename )
+static void
+ParseJSONFile( JSONDocument& doc, const std::string& filename )
 {
-  JSONDocument       ans;
-  std::ifstream      input( filename );
-  std::ostringstream ss;
-  ss << input.rdbuf();
+  static thread_local std::vector<char> buffer( 1 << 16 );
+
+  rapidjson::ParseResult results;
+  std::unique_ptr<std::FILE, int(*)( std::FILE* )> input(
+    std::fopen( filename.c_str(), "rb" ), &std::fclose );
 
-  rapidjson::ParseResult results = ans.Parse( ss.str().c_str() );
+  if( input ){
+    rapidjson::FileReadStream stream( input.get(),
+                                      buffer.data(),
+                                      buffer.size() );
+    results = doc.ParseStream( stream );
+  } else {
+    results = doc.Parse( "" );
+  }
 
   if( !results ){
     throw std::invalid_argument(
@@ -101,51 +114,95 @@ FromJSONFile( const std::string& filename )
                        filename,
                        rapidjson::GetParseErrorFunc( results.Code() ) ) );
   }
+}
+
 
+/**
+ * @brief Getting a json document from a single input files
+ *
+ * This function is basically a wrap for using the standard
+ * `rapidjson::Document::ParseStream` function, for using a C++ string to
+ * identify the file to open.
+ */
+JSONDocument
+FromJSONFile( const std::string& filename )
+{
+  JSONDocument ans;
+  ParseJSONFile( ans, filename );
   return ans;
 }
 
 
+/**
+ * @brief Merging JSON maps by moving the values of the source map.
+ *
+ * Identical to usr::MergeJSON in terms of the merging results (including
+ * where the merging stops for mismatched types), but the values of the source
+ * map are moved rather than copied. The source map must therefore use the same
+ * allocator as the destination map, and is left in an unspecified state.
+ */
+static bool
+MoveMergeJSON( JSONMap&                     dstObject,
+               JSONMap&                     srcObject,
+               JSONDocument::AllocatorType& allocator )
+{
+  for( auto srcIt = srcObject.MemberBegin();
+       srcIt != srcObject.MemberEnd(); ++srcIt ){
+    auto dstIt = dstObject.FindMember( srcIt->name );
+    if( dstIt == dstObject.MemberEnd() ){
+      dstObject.AddMember( srcIt->name, srcIt->value, allocator );
+    } else {
+      if( srcIt->value.GetType() != dstIt->value.GetType() ){
+        return false;
+      }
+
+      if( srcIt->value.IsArray() ){
+        for( auto arrayIt = srcIt->value.Begin();
+             arrayIt != srcIt->value.End(); ++arrayIt ){
+          dstIt->value.PushBack( *arrayIt, allocator );
+        }
+      } else if( srcIt->value.IsObject() ){
+        if( !MoveMergeJSON( dstIt->value, srcIt->value, allocator ) ){
+          return false;
+        }
+      } else {
+        dstIt->value = srcIt->value;
+      }
+    }
+  }
+
+  return true;
+}
+
+
 /**
  * @brief Getting the joint JSON document from multiple inputs.
  *
- * For each JSON in the entry, the JSON file is joint using the `usr::MergeJSON`
- * method to the previous files. To ensure memory ownership, the final merge
- * results is passed to a string output processes and the return object is a
- * standalone JSON map instance that parses the generated string.
+ * For each JSON in the entry, the JSON file is joint to the previous files
+ * following the rules of the `usr::MergeJSON` method. All files are parsed
+ * using the allocator of the returned document, so that the values can be
+ * moved into the returned document without copying, and the return object
+ * is a standalone JSON map instance.
  */
 JSONDocument
 FromJSONFiles( const std::vector<std::string>& files )
 {
+  JSONDocument ans;
+
   if( files.size() == 0 ){
-    JSONDocument ans;
     ans.Parse( "{}" );
     return ans;
-  } else {
-    JSONDocument first = FromJSONFile( files[0] );
-
-    for( unsigned i = 1; i < files.size(); ++i ){
-      JSONDocument temp = FromJSONFile( files[i] );
-      MergeJSON( first, temp, temp.GetAllocator() );
-    }
-
-    // After the merging, print the first to a string then have
-    // RapidJson pare the string again to avoid assertion errors
-    rapidjson::StringBuffer                    buffer;
-    rapidjson::Writer<rapidjson::StringBuffer> writer( buffer );
-    first.Accept( writer );
-
-    JSONDocument           ans;
-    rapidjson::ParseResult results = ans.Parse( buffer.GetString() );
+  }
 
-    if( !results ){
-      throw std::invalid_argument(
-              usr::fstr( "Error Joining json files (%s)",
-                         rapidjson::GetParseErrorFunc( results.Code() ) ) );
-    }
+  ParseJSONFile( ans, files[0] );
 
-    return ans;
+  for( unsigned i = 1; i < files.size(); ++i ){
+    JSONDocument temp( &ans.GetAllocator() );
+    ParseJSONFile( temp, files[i] );
+    MoveMergeJSON( ans, temp, ans.GetAllocator() );
   }
+
+  return ans;
 }
 
 
@@ -13,6 +13,11 @@
 #include "UserUtils/Common/STLUtils/VectorUtils.hpp"
 #endif
 
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+
 namespace usr
 {
 
@@ -58,16 +63,17 @@ namespace usr
 RooArgContainer::RooArgContainer( const std::vector<RooCmdArg>& arglist,
                                   const std::vector<RooCmdArg>& default_list )
 {
-  std::set<std::string> nameset;
+  reserve( arglist.size()+default_list.size() );
+  _index.reserve( arglist.size()+default_list.size() );
 
   for( const auto& arg : arglist ){
-    if( nameset.insert( arg.GetName() ).second ){
+    if( _index.emplace( arg.GetName(), size() ).second ){
       push_back( arg );
     }
   }
 
   for( const auto& arg : default_list ){
-    if( nameset.insert( arg.GetName() ).second ){
+    if( _index.emplace( arg.GetName(), size() ).second ){
       push_back( arg );
     }
   }
@@ -83,11 +89,7 @@ RooArgContainer::~RooArgContainer(){}
 bool
 RooArgContainer::Has( const std::string& name ) const
 {
-  auto iter = std::find_if( begin(),
-                            end(), [&name]( const RooCmdArg& item ){
-      return item.GetName() == name;
-    } );
-  return iter != end();
+  return Find( name ) != size();
 }
 
 
@@ -99,11 +101,36 @@ RooArgContainer::Has( const std::string& name ) const
 const RooCmdArg&
 RooArgContainer::Get( const std::string& name ) const
 {
-  auto iter = std::find_if( begin(),
-                            end(), [&name]( const RooCmdArg& item ){
-      return item.GetName() == name;
-    } );
-  return *iter;
+  return *( begin()+Find( name ) );
+}
+
+
+/**
+ * @brief Position of the first command with a given name, returns the size of
+ * the container if not found.
+ *
+ * The look up uses the name index generated at construction. As the container
+ * is still a std::vector that can be modified after construction, an indexed
+ * position is only used if the entry at that position still has the requested
+ * name, otherwise the container is scanned linearly. The index itself is never
+ * modified, so concurrent look ups are safe.
+ */
+size_t
+RooArgContainer::Find( const std::string& name ) const
+{
+  const auto iter = _index.find( name );
+  if( iter != _index.end() && iter->second < size()
+      && name == ( *this )[iter->second].GetName() ){
+    return iter->second;
+  }
+
+  for( size_t i = 0; i < size(); ++i ){
+    if( name == ( *this )[i].GetName() ){
+      return i;
+    }
+  }
+
+  return size();
 }
 
 
@@ -138,8 +165,7 @@ RooArgContainer::MakeRooList( const std::vector<std::string>& exclude ) const
 
   for( const auto& arg : *this ){
     // Ignoring custom arguments
-    if( usr::FindValue( CustomCommandList,
-                        std::string( arg.GetName() ) ) ||
+    if( IsCustomCommand( arg.GetName() ) ||
         usr::FindValue( exclude, std::string( arg.GetName() ) ) ){
       continue;
     }
@@ -172,10 +198,11 @@ std::string
 RooArgContainer::GetStr( const std::string& name, const unsigned index  ) const
 {
   assert( index == 0 || index == 1 );
+  const RooCmdArg& arg = Get( name );
 
-  return Get( name ).getString( 0 ) == 0 ?
+  return arg.getString( 0 ) == 0 ?
          "" :
-         Get( name ).getString( 0 );
+         arg.getString( 0 );
 }
 
 
@@ -183,22 +210,85 @@ const TObject&
 RooArgContainer::GetObj( const std::string& name, const unsigned index  ) const
 {
   assert( index == 0 || index == 1 );
-  assert( Get( name ).getObject( index ) != 0 );
-  return *Get( name ).getObject( index );
+  const RooCmdArg& arg = Get( name );
+  assert( arg.getObject( index ) != 0 );
+  return *arg.getObject( index );
 }
 
 
 /**
- * @brief The list of custom commands that is used defined.
+ * @brief The registry of custom commands that is used defined.
  *
  * Keeping track of custom defined commands is essential for generating the
  * RooLinkedList to pass on-to standard RooFit functions (fitTo, plotOn, etc.).
- * A
- * static list is used to keep track of every new command declared by the
- * package
- * and the user.
+ * The registry is a function-local static object, so it is constructed on the
+ * first registration regardless of the initialization order of the static
+ * variables in the various translation units, and is guarded by a
+ * reader--writer lock so it can be queried from multiple threads. The names
+ * are also kept in a list in the order of registration.
  */
-std::vector<std::string> RooArgContainer::CustomCommandList;
+namespace
+{
+
+struct CommandRegistry
+{
+  std::unordered_set<std::string> names;
+  std::vector<std::string>        list;
+  std::shared_mutex               mutex;
+};
+
+CommandRegistry&
+GetCommandRegistry()
+{
+  static CommandRegistry registry;
+  return registry;
+}
+
+}
+
+/**
+ * @brief List of the custom commands in the order of registration.
+ *
+ * The list is held by the function-local registry, so this can be called
+ * during the static initialization of other translation units. The returned
+ * reference is a read-only view of the registry, and should not be held while
+ * other threads can still register new commands. Use
+ * RooArgContainer::CustomCommands and RooArgContainer::IsCustomCommand for
+ * thread-safe queries.
+ */
+const std::vector<std::string>&
+RooArgContainer::CustomCommandList()
+{
+  return GetCommandRegistry().list;
+}
+
+
+/**
+ * @brief Sorted list of all registered custom commands.
+ */
+std::vector<std::string>
+RooArgContainer::CustomCommands()
+{
+  CommandRegistry&                    registry = GetCommandRegistry();
+  std::shared_lock<std::shared_mutex> lock( registry.mutex );
+  std::vector<std::string>            ans( registry.names.begin(),
+                                           registry.names.end() );
+  std::sort( ans.begin(), ans.end() );
+  return ans;
+}
+
+
+/**
+ * @brief Checking if a command name is a registered custom command.
+ */
+bool
+RooArgContainer::IsCustomCommand( const std::string& cmd )
+{
+  CommandRegistry&                    registry = GetCommandRegistry();
+  std::shared_lock<std::shared_mutex> lock( registry.mutex );
+  return registry.names.count( cmd );
+}
+
 
 /**
  * @brief Adding a command to the custom commands list.
@@ -210,9 +300,15 @@ std::vector<std::string> RooArgContainer::CustomCommandList;
 unsigned
 RooArgContainer::RegistorCommand( const std::string& cmd )
 {
-  assert( usr::FindValue( CustomCommandList, cmd ) == false );
-  CustomCommandList.push_back( cmd );
-  return CustomCommandList.size();
+  CommandRegistry&                    registry = GetCommandRegistry();
+  std::unique_lock<std::shared_mutex> lock( registry.mutex );
+  const bool                          inserted =
+    registry.names.insert( cmd ).second;
+  assert( inserted );
+  if( inserted ){
+    registry.list.push_back( cmd );
+  }
+  return registry.names.size();
 }
 
 }// namespace usr
@@ -11,7 +11,24 @@
 #endif
 
 #include "TError.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
 #include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <unistd.h>
 
 namespace usr
 {
@@ -23,10 +40,16 @@ namespace usr
 std::ostream&
 operator<<( std::ostream& os, const clearline& )
 {
-  for( size_t i = 0; i < 255; ++i ){
-    os << "\b \b" << std::flush;
-  }
+  static const std::string clear = [](){
+                                     std::string ans;
+
+                                     for( size_t i = 0; i < 255; ++i ){
+                                       ans += "\b \b";
+                                     }
 
+                                     return ans;
+                                   }();
+  os << clear << std::flush;
   return os;
 }
 
@@ -45,10 +68,7 @@ separator::~separator(){}
 std::ostream&
 operator<<( std::ostream& os, const separator& x )
 {
-  for( size_t i = 0; i < x.n; ++i ){
-    os << x.token << std::flush;
-  }
-
+  os << std::string( x.n, x.token ) << std::flush;
   return os;
 }
 
@@ -70,6 +90,123 @@ print_progress( const std::string& header,
 }
 
 
+/*-----------------------------------------------------------------------------
+ *  ProgressReporter
+   --------------------------------------------------------------------------*/
+
+namespace log
+{
+
+static void WriteProgress( const std::string& line,
+                           const bool         istty,
+                           const bool         final );
+
+}/* log */
+
+/**
+ * @brief Setting up the progress reporter with the header string, the total
+ * number of counts expected and the refresh interval in seconds.
+ */
+ProgressReporter::ProgressReporter( const std::string& header,
+                                    const size_t       total,
+                                    const double       refresh ) :
+  _header    ( header ),
+  _total     ( total ),
+  _istty     ( isatty( fileno( stderr ) ) ),
+  _finished  ( false ),
+  _lastlength( 0 ),
+  _start     ( clock::now() ),
+  _count     ( 0 ),
+  _lastdraw  ( 0 )
+{
+  const double interval = _istty ?
+                          refresh :
+                          std::max( refresh, 10.0 );
+  _interval = interval * 1e9;
+}
+
+
+ProgressReporter::~ProgressReporter()
+{
+  Finish();
+}
+
+
+/**
+ * @brief Adding counts to the progress, thread-safe.
+ *
+ * Only the thread that crosses the refresh interval will redraw the progress
+ * line, all other calls only involve an atomic increment and a clock read.
+ */
+void
+ProgressReporter::Add( const size_t n )
+{
+  _count.fetch_add( n, std::memory_order_relaxed );
+
+  const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    clock::now()-_start ).count();
+  int64_t last = _lastdraw.load( std::memory_order_relaxed );
+
+  if( now-last >= _interval
+      && _lastdraw.compare_exchange_strong( last, now ) ){
+    std::unique_lock<std::mutex> lock( _drawmutex, std::try_to_lock );
+    if( lock.owns_lock() && !_finished ){
+      Draw( false );
+    }
+  }
+}
+
+
+/**
+ * @brief Printing the final state of the progress, subsequent calls have no
+ * effect.
+ */
+void
+ProgressReporter::Finish()
+{
+  std::lock_guard<std::mutex> lock( _drawmutex );
+  if( _finished ){ return; }
+  _finished = true;
+  Draw( true );
+}
+
+
+void
+ProgressReporter::Draw( const bool final )
+{
+  const size_t count   = _count.load( std::memory_order_relaxed );
+  const double elapsed = std::chrono::duration<double>(
+    clock::now()-_start ).count();
+  const double rate = elapsed > 0 ? count / elapsed : 0;
+
+  std::string line = fstr( "[%s] %u/%u", _header, count, _total );
+  if( _total > 0 ){
+    line += fstr( " (%.1f%%)", 100.0 * count / _total );
+  }
+  line += fstr( " %.1f/s", rate );
+
+  const double eta = final ? elapsed :
+                     rate > 0 && _total > count ? ( _total-count ) / rate :
+                     0;
+  const unsigned sec = eta;
+  line += fstr( final ? " Elapsed %02u:%02u:%02u" : " ETA %02u:%02u:%02u",
+                sec / 3600, ( sec / 60 ) % 60, sec % 60 );
+
+  if( _istty ){
+    // Overwriting the previous line, padding with spaces if shorter.
+    const size_t length = line.length();
+    if( length < _lastlength ){
+      line.append( _lastlength-length, ' ' );
+    }
+    _lastlength = length;
+  }
+
+  // Written by the log backend, so that the progress line is never
+  // interleaved with the log lines.
+  log::WriteProgress( line, _istty, final );
+}
+
+
 /**
  * @brief Very simple function for generating the print level control.
  *
@@ -106,7 +243,7 @@ print_progress( const std::string& header,
 namespace log
 {
 
-short __global_log_level = WARNING;
+static std::atomic<short> __global_log_level( WARNING );
 
 /**
  * @details
@@ -120,26 +257,386 @@ SetLogLevel( const short new_level )
 }
 
 
+/*-----------------------------------------------------------------------------
+ *  Log writing backend
+   --------------------------------------------------------------------------*/
+
+/**
+ * @brief Backend for writing the log lines to STDERR and the additional log
+ * files.
+ *
+ * Log lines are passed through a fixed-size lock-free ring buffer (a bounded
+ * multi-producer queue with per-slot sequence numbers), and written by a
+ * single background thread, so that threads generating logs are not
+ * throttled by slow terminals or files, and lines from different threads are
+ * never interleaved. If the buffer is full, the producing thread waits for the
+ * writer thread to free up space, so no logs are lost. In synchronous mode
+ * (the default, see usr::log::SetLogAsync), or after the backend has been shut
+ * down at program exit, the lines are written directly by the calling thread.
+ *
+ * As pending lines are lost if the program is aborted, logs of level ERROR and
+ * above are flushed before PrintLog returns, and the pending lines are also
+ * written by a std::terminate handler before the previously installed handler
+ * is called.
+ *
+ * The writer thread does not exist in a child process created by fork, so the
+ * backend of the child process is switched to synchronous writes (lines still
+ * pending in the parent at the time of the fork are left to the parent).
+ */
+class LogBackend
+{
+public:
+  static LogBackend& Instance();
+
+  void Push( std::string&& line );
+  void Flush();
+  void SetAsync( const bool async );
+  void AddFile( const std::string& filename );
+  void ClearFiles();
+  void Shutdown();
+  void Progress( const std::string& line, const bool istty, const bool final );
+
+private:
+  LogBackend();
+
+  struct Cell
+  {
+    std::atomic<size_t> seq;
+    std::string         line;
+  };
+
+  static const size_t capacity = 1024;// Must be a power of 2
+
+  std::unique_ptr<Cell[]> _cells;
+  std::atomic<size_t> _enqueue;
+  size_t _dequeue;// Only accessed by the writer thread.
+  std::atomic<size_t> _written;
+
+  std::atomic<bool> _async;
+  std::atomic<bool> _running;
+  std::thread _writer;
+  std::mutex _wakemutex;
+  std::condition_variable _wake;
+
+  std::mutex _sinkmutex;
+  std::vector<std::unique_ptr<std::ofstream> > _files;
+  std::string _progress;// Progress line presently displayed on the terminal
+
+  bool TryPush( std::string& line );
+  bool TryPop( std::string& line );
+  void Write( const std::string& line );
+  void Run();
+
+  std::terminate_handler _prevterminate;
+
+  static void PrepareFork();
+  static void ParentFork();
+  static void ChildFork();
+  static void Terminate();
+};
+
+
+/**
+ * @brief The backend is intentionally never destroyed, so that logs can still
+ * be generated by static objects at program exit. The writer thread is
+ * stopped and all pending logs written by an exit handler.
+ */
+LogBackend&
+LogBackend::Instance()
+{
+  static LogBackend* instance = new LogBackend();
+  return *instance;
+}
+
+
+LogBackend::LogBackend() :
+  _cells  ( new Cell[capacity] ),
+  _enqueue( 0 ),
+  _dequeue( 0 ),
+  _written( 0 ),
+  _async  ( false ),
+  _running( true )
+{
+  for( size_t i = 0; i < capacity; ++i ){
+    _cells[i].seq.store( i, std::memory_order_relaxed );
+  }
+
+  _writer = std::thread( [this](){ Run(); } );
+  std::atexit( [](){ LogBackend::Instance().Shutdown(); } );
+  pthread_atfork( PrepareFork, ParentFork, ChildFork );
+  _prevterminate = std::set_terminate( Terminate );
+}
+
+
+/**
+ * @brief Writing the pending logs before the program is terminated. The
+ * pending logs cannot be written if the writer thread itself is terminating.
+ */
+void
+LogBackend::Terminate()
+{
+  LogBackend& backend = Instance();
+  if( std::this_thread::get_id() != backend._writer.get_id() ){
+    backend.Flush();
+  }
+  if( backend._prevterminate ){
+    backend._prevterminate();
+  }
+  std::abort();
+}
+
+
+/**
+ * @brief Holding the sink lock across a fork, so that the child process
+ * doesn't inherit the lock in the middle of a write.
+ */
+void
+LogBackend::PrepareFork()
+{
+  Instance()._sinkmutex.lock();
+}
+
+
+void
+LogBackend::ParentFork()
+{
+  Instance()._sinkmutex.unlock();
+}
+
+
+/**
+ * @brief The writer thread is not copied to the child process, marking the
+ * backend as stopped such that lines are written synchronously, Flush returns
+ * immediately, and the exit handler doesn't attempt to join the writer thread.
+ */
+void
+LogBackend::ChildFork()
+{
+  LogBackend& backend = Instance();
+  backend._running = false;
+  backend._sinkmutex.unlock();
+}
+
+
+bool
+LogBackend::TryPush( std::string& line )
+{
+  size_t pos = _enqueue.load( std::memory_order_relaxed );
+
+  while( true ){
+    Cell&           cell = _cells[pos & ( capacity-1 )];
+    const size_t    seq  = cell.seq.load( std::memory_order_acquire );
+    const ptrdiff_t diff = (ptrdiff_t)seq-(ptrdiff_t)pos;
+
+    if( diff == 0 ){
+      if( _enqueue.compare_exchange_weak( pos, pos+1,
+                                          std::memory_order_relaxed ) ){
+        cell.line = std::move( line );
+        cell.seq.store( pos+1, std::memory_order_release );
+        return true;
+      }
+    } else if( diff < 0 ){
+      return false;// Buffer is full
+    } else {
+      pos = _enqueue.load( std::memory_order_relaxed );
+    }
+  }
+}
+
+
+bool
+LogBackend::TryPop( std::string& line )
+{
+  Cell& cell = _cells[_dequeue & ( capacity-1 )];
+  if( cell.seq.load( std::memory_order_acquire ) != _dequeue+1 ){
+    return false;
+  }
+
+  line = std::move( cell.line );
+  cell.seq.store( _dequeue+capacity, std::memory_order_release );
+  ++_dequeue;
+  return true;
+}
+
+
+/**
+ * @brief Writing a log line to all sinks. If a progress line is displayed on
+ * the terminal, it is cleared before the log line is written, and redrawn
+ * below it.
+ */
+void
+LogBackend::Write( const std::string& line )
+{
+  std::lock_guard<std::mutex> lock( _sinkmutex );
+  if( !_progress.empty() ){
+    std::cerr << '\r' << std::string( _progress.length(), ' ' ) << '\r';
+  }
+  std::cerr << line << '\n';
+  if( !_progress.empty() ){
+    std::cerr << _progress;
+  }
+  std::cerr << std::flush;
+
+  for( auto& file : _files ){
+    *file << line << std::endl;
+  }
+}
+
+
+/**
+ * @brief Drawing a progress line on STDERR (see usr::ProgressReporter). On a
+ * terminal, the line overwrites the presently displayed progress line, and is
+ * kept at the bottom of the terminal until the final state is drawn.
+ */
+void
+LogBackend::Progress( const std::string& line,
+                      const bool         istty,
+                      const bool         final )
+{
+  std::lock_guard<std::mutex> lock( _sinkmutex );
+  if( istty ){
+    std::cerr << '\r' << line;
+    if( final ){ std::cerr << '\n'; }
+    std::cerr << std::flush;
+    _progress = final ? "" : line;
+  } else {
+    std::cerr << line << std::endl;
+  }
+}
+
+
+void
+LogBackend::Run()
+{
+  std::string line;
+
+  while( true ){
+    while( TryPop( line ) ){
+      Write( line );
+      _written.fetch_add( 1, std::memory_order_release );
+    }
+
+    if( !_running && _dequeue == _enqueue.load() ){
+      break;
+    }
+
+    std::unique_lock<std::mutex> lock( _wakemutex );
+    _wake.wait_for( lock, std::chrono::milliseconds( 20 ) );
+  }
+}
+
+
+void
+LogBackend::Push( std::string&& line )
+{
+  if( !_async || !_running ){
+    Write( line );
+    return;
+  }
+
+  while( !TryPush( line ) ){
+    _wake.notify_one();
+    std::this_thread::yield();
+  }
+
+  _wake.notify_one();
+}
+
+
+/**
+ * @brief Waiting until all lines pushed before the call has been written.
+ */
+void
+LogBackend::Flush()
+{
+  const size_t target = _enqueue.load();
+
+  while( _running && _written.load( std::memory_order_acquire ) < target ){
+    _wake.notify_one();
+    std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+  }
+}
+
+
+void
+LogBackend::SetAsync( const bool async )
+{
+  Flush();
+  _async = async;
+}
+
+
+void
+LogBackend::AddFile( const std::string& filename )
+{
+  auto file = std::make_unique<std::ofstream>( filename, std::ios::app );
+  if( !file->is_open() ){
+    throw std::runtime_error( "Cannot open log file " + filename );
+  }
+
+  std::lock_guard<std::mutex> lock( _sinkmutex );
+  _files.push_back( std::move( file ) );
+}
+
+
+void
+LogBackend::ClearFiles()
+{
+  Flush();
+  std::lock_guard<std::mutex> lock( _sinkmutex );
+  _files.clear();
+}
+
+
+/**
+ * @brief Writing all pending logs and stopping the writer thread.
+ */
+void
+LogBackend::Shutdown()
+{
+  if( !_running.exchange( false ) ){ return; }
+  _wake.notify_one();
+  _writer.join();
+}
+
+
+static void
+WriteProgress( const std::string& line, const bool istty, const bool final )
+{
+  LogBackend::Instance().Progress( line, istty, final );
+}
+
+
+static thread_local std::string __thread_tag;
+
 /**
  * @details
- * The output will be passed to STDERR such that logs can be stored seperately
- * of
- * nominal analysis output for simpler debugging.
+ * The output will be passed to STDERR (and the files added via AddLogFile)
+ * such that logs can be stored seperately of nominal analysis output for
+ * simpler debugging. The logs can be written asynchronously by a background
+ * thread (see SetLogAsync), in which case logs of level ERROR and above are
+ * written, together with all pending logs, before this function returns (or
+ * before the exception of a FATAL log is raised).
  */
 void
 PrintLog( const short        level,
           const std::string& line,
           const std::string& header )
 {
+  if( level < __global_log_level && level < FATAL ){
+    return;
+  }
+
   const std::string msg = header.size() > 0 ?
                           header+" "+line :
                           line;
   if( level >= __global_log_level ){
-    if( header.size() > 0 ){
-      std::cerr << header << " " << line << std::endl;
-    } else {
-      std::cerr << line << std::endl;
-    }
+    LogBackend::Instance().Push( __thread_tag.empty() ?
+                                 std::string( msg ) :
+                                 "["+__thread_tag+"] "+msg );
+  }
+  if( level >= ERROR ){
+    LogBackend::Instance().Flush();
   }
   if( level >= FATAL ){
     throw std::runtime_error( msg );
@@ -147,6 +644,57 @@ PrintLog( const short        level,
 }
 
 
+/**
+ * @details The tag is printed in square brackets at the start of each log line
+ * generated by the calling thread. An empty tag disables the prefix.
+ */
+void
+SetThreadTag( const std::string& tag )
+{
+  __thread_tag = tag;
+}
+
+
+/**
+ * @details The file is opened in append mode, and an exception is raised if
+ * the file cannot be opened.
+ */
+void
+AddLogFile( const std::string& filename )
+{
+  LogBackend::Instance().AddFile( filename );
+}
+
+
+void
+ClearLogFiles()
+{
+  LogBackend::Instance().ClearFiles();
+}
+
+
+/**
+ * @details Logs are written synchronously by default. In synchronous mode, the
+ * logs are written directly by the calling thread, which ensures the logs are
+ * properly ordered with other outputs of the program (at the cost of blocking
+ * the calling thread), and that no logs are lost if the program is aborted.
+ * In asynchronous mode, logs below the ERROR level that are still pending are
+ * lost if the program is aborted by a signal.
+ */
+void
+SetLogAsync( const bool async )
+{
+  LogBackend::Instance().SetAsync( async );
+}
+
+
+void
+FlushLog()
+{
+  LogBackend::Instance().Flush();
+}
+
+
 /**
  * @brief Dummy function for forcing a global setting of the ROOT output level.
  */
@@ -12,12 +12,18 @@
 #endif
 
 #include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <regex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/range/algorithm_ext/erase.hpp>
@@ -241,4 +247,271 @@ ends_with( const std::string& master, const std::string& target )
   return std::equal( target.rbegin(), target.rend(), master.rbegin() );
 }
 
+
+/*-----------------------------------------------------------------------------
+ *  Fast formatting routine
+   --------------------------------------------------------------------------*/
+namespace fmt
+{
+
+namespace base
+{
+
+/**
+ * @brief Single printf style directive parsed from a format string.
+ */
+struct fstrspec
+{
+  bool left;
+  bool plus;
+  bool zero;
+  int  width;
+  int  precision;
+  char conv;
+};
+
+/**
+ * @brief Format string split into literal strings and directives. The literal
+ * text before the i-th directive is stored in text[i], with the text after
+ * the last directive stored in text.back().
+ */
+struct fstrparsed
+{
+  bool                     valid;
+  std::vector<std::string> text;
+  std::vector<fstrspec>    spec;
+  size_t                   reserve;// < Estimated length of the output
+};
+
+/**
+ * @brief Parsing a format string, flagging the format as invalid for the fast
+ * routine if any part of the format is not a simple printf directive
+ * (positional arguments, tabulations, alternate forms, ...).
+ */
+static fstrparsed
+ParseFstr( const std::string& fmt )
+{
+  fstrparsed ans = {true, {""}, {}, 0};
+
+  for( size_t i = 0; i < fmt.length(); ++i ){
+    if( fmt[i] != '%' ){
+      ans.text.back() += fmt[i];
+      continue;
+    }
+    if( ++i >= fmt.length() ){ ans.valid = false; break; }
+    if( fmt[i] == '%' ){
+      ans.text.back() += '%';
+      continue;
+    }
+
+    fstrspec spec = {false, false, false, -1, -1, 0};
+
+    for( ; i < fmt.length(); ++i ){
+      if( fmt[i] == '-' ){
+        spec.left = true;
+      } else if( fmt[i] == '+' ){
+        spec.plus = true;
+      } else if( fmt[i] == '0' ){
+        spec.zero = true;
+      } else {
+        break;
+      }
+    }
+
+    if( i < fmt.length() && std::isdigit( (unsigned char)fmt[i] ) ){
+      spec.width = 0;
+
+      for( ; i < fmt.length() && std::isdigit( (unsigned char)fmt[i] ); ++i ){
+        spec.width = spec.width * 10+( fmt[i]-'0' );
+      }
+    }
+    if( i < fmt.length() && fmt[i] == '.' ){
+      ++i;
+      if( i >= fmt.length() || !std::isdigit( (unsigned char)fmt[i] ) ){
+        ans.valid = false;
+        break;
+      }
+      spec.precision = 0;
+
+      for( ; i < fmt.length() && std::isdigit( (unsigned char)fmt[i] ); ++i ){
+        spec.precision = spec.precision * 10+( fmt[i]-'0' );
+      }
+    }
+
+    for( ; i < fmt.length() && fmt[i] != '\0'
+         && std::strchr( "hlLqjzt", fmt[i] ); ++i ){
+    }
+
+    if( i >= fmt.length() || fmt[i] == '\0'
+        || !std::strchr( "diusfeEgG", fmt[i] )
+        || spec.width > 1024 || spec.precision > 256
+        || ( spec.left && spec.zero ) ){
+      ans.valid = false;
+      break;
+    }
+
+    spec.conv = fmt[i];
+    ans.spec.push_back( spec );
+    ans.text.push_back( "" );
+  }
+
+  for( const auto& text : ans.text ){
+    ans.reserve += text.length();
+  }
+
+  for( const auto& spec : ans.spec ){
+    ans.reserve += std::max( spec.width, 24 );
+  }
+
+  return ans;
+}
+
+
+/**
+ * @brief Appending a formatted field with padding.
+ *
+ * The numerical sign (the first `nsign` characters of the field) is placed
+ * before the zero padding, similar to the std::ios::internal alignment.
+ */
+static void
+AppendPadded( std::string&    ans,
+              const char*     str,
+              const size_t    len,
+              const size_t    nsign,
+              const fstrspec& spec )
+{
+  const size_t width = spec.width < 0 ? 0 : spec.width;
+  const size_t npad  = width > len ? width-len : 0;
+
+  if( spec.left ){
+    ans.append( str, len );
+    ans.append( npad, ' ' );
+  } else if( spec.zero ){
+    ans.append( str, nsign );
+    ans.append( npad, '0' );
+    ans.append( str+nsign, len-nsign );
+  } else {
+    ans.append( npad, ' ' );
+    ans.append( str, len );
+  }
+}
+
+
+/**
+ * @brief Appending a single argument according to the directive, returning
+ * false for argument--directive combinations where the output of the
+ * boost::format is not reproduced.
+ */
+static bool
+AppendArg( std::string& ans, const fstrspec& spec, const fstrarg& arg )
+{
+  char buf[512];
+
+  switch( arg.type ){
+  case fstrarg::STRING:
+    if( spec.conv != 's' || spec.precision >= 0 || spec.zero ){
+      return false;
+    }
+    AppendPadded( ans, arg.s, arg.n, 0, spec );
+    return true;
+
+  case fstrarg::SIGNED:
+  case fstrarg::UNSIGNED: {
+    // Integers are always printed in decimal by the stream, regardless of the
+    // floating point conversion specifier.
+    if( spec.precision >= 0 ){ return false; }
+    char*  ptr   = buf;
+    size_t nsign = 0;
+    if( arg.type == fstrarg::SIGNED && arg.i >= 0 && spec.plus ){
+      *ptr++ = '+';
+    }
+    const auto res = arg.type == fstrarg::SIGNED ?
+                     std::to_chars( ptr, buf+sizeof( buf ), arg.i ) :
+                     std::to_chars( ptr, buf+sizeof( buf ), arg.u );
+    if( buf[0] == '+' || buf[0] == '-' ){ nsign = 1; }
+    AppendPadded( ans, buf, res.ptr-buf, nsign, spec );
+    return true;
+  }
+
+  case fstrarg::FLOAT: {
+    // Directives without floating point conversion use the default stream
+    // representation, which is equivalent to %g.
+    const bool isfloat = std::strchr( "feEgG", spec.conv ) != nullptr;
+    if( !isfloat && spec.precision >= 0 ){ return false; }
+    if( spec.zero && !std::isfinite( arg.d ) ){ return false; }
+    char  cfmt[16];
+    char* c = cfmt;
+    *c++ = '%';
+    if( spec.plus ){ *c++ = '+'; }
+    *c++ = '.';
+    *c++ = '*';
+    *c++ = isfloat ? spec.conv : 'g';
+    *c   = '\0';
+    const int len = std::snprintf( buf, sizeof( buf ), cfmt,
+                                   spec.precision < 0 ? 6 : spec.precision,
+                                   arg.d );
+    if( len < 0 || len >= (int)sizeof( buf ) ){ return false; }
+    const size_t nsign = ( buf[0] == '+' || buf[0] == '-' ) ? 1 : 0;
+    AppendPadded( ans, buf, len, nsign, spec );
+    return true;
+  }
+  }
+
+  return false;
+}
+
+
+/**
+ * @brief Fast implementation of the usr::fstr function for numerical and
+ * string arguments.
+ *
+ * The format string is parsed once per thread and cached, and the output is
+ * appended directly to `ans` (with the capacity reserved from the cached
+ * parse) without the intermediate streams used by boost::format. The function
+ * returns false if either the format string or one of the arguments cannot be
+ * handled, or if the number of arguments doesn't match the format, in which
+ * case `ans` is left unchanged and the caller should fall back to
+ * boost::format (which also takes care of raising the appropriate exceptions).
+ */
+bool
+fstr_fast( std::string&       ans,
+           const std::string& fmt,
+           const fstrarg*     args,
+           const size_t       nargs )
+{
+  static thread_local std::unordered_map<std::string, fstrparsed> cache;
+  static const size_t max_cache = 1024;
+
+  auto iter = cache.find( fmt );
+  if( iter == cache.end() ){
+    if( cache.size() >= max_cache ){
+      cache.clear();
+    }
+    iter = cache.emplace( fmt, ParseFstr( fmt ) ).first;
+  }
+
+  const fstrparsed& parsed = iter->second;
+  if( !parsed.valid || parsed.spec.size() != nargs ){
+    return false;
+  }
+
+  const size_t original = ans.length();
+  ans.reserve( original+parsed.reserve );
+
+  for( size_t i = 0; i < nargs; ++i ){
+    ans += parsed.text[i];
+    if( !AppendArg( ans, parsed.spec[i], args[i] ) ){
+      ans.resize( original );
+      return false;
+    }
+  }
+
+  ans += parsed.text.back();
+  return true;
+}
+
+}/* base */
+
+}/* fmt */
+
 }/* usr  */
@@ -0,0 +1,74 @@
+/**
+ * @file    STLUtils_VectorUtils.cc
+ * @brief   Non-template helper functions for the vector utilities.
+ * @author  [Yi-Mu "Enoch" Chen](https://github.com/yimuchen)
+ */
+#ifdef CMSSW_GIT_HASH
+#include "UserUtils/Common/interface/STLUtils/VectorUtils.hpp"
+#else
+#include "UserUtils/Common/STLUtils/VectorUtils.hpp"
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace usr
+{
+
+namespace base
+{
+
+/**
+ * @brief Opening the file for reading.
+ *
+ * Regular files with non-zero size are memory mapped with a sequential access
+ * hint. If the file is not a regular file, or if the mapping fails, the
+ * contents are read into an internal buffer instead.
+ */
+FileView::FileView( const std::string& file ) :
+  _data( nullptr ),
+  _size( 0 ),
+  _map( nullptr )
+{
+  const int fd = ::open( file.c_str(), O_RDONLY );
+  if( fd < 0 ){ return; }
+
+  struct stat info;
+  if( ::fstat( fd, &info ) == 0 && S_ISREG( info.st_mode )
+      && info.st_size > 0 ){
+    void* map = ::mmap( nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if( map != MAP_FAILED ){
+      ::madvise( map, info.st_size, MADV_SEQUENTIAL );
+      _map  = map;
+      _data = static_cast<const char*>( map );
+      _size = info.st_size;
+      ::close( fd );
+      return;
+    }
+  }
+
+  char    chunk[1 << 16];
+  ssize_t n;
+
+  while( ( n = ::read( fd, chunk, sizeof( chunk ) ) ) > 0 ){
+    _buffer.append( chunk, n );
+  }
+
+  ::close( fd );
+  _data = _buffer.data();
+  _size = _buffer.size();
+}
+
+
+FileView::~FileView()
+{
+  if( _map ){
+    ::munmap( _map, _size );
+  }
+}
+
+}/* base */
+
+}/* usr */
@@ -0,0 +1,36 @@
+/**
+ * @file    SystemUtils_Thread.cc
+ * @brief   Implementation of the non-template worker pool helper functions
+ * @author  [Yi-Mu "Enoch" Chen](https://github.com/yimuchen)
+ */
+#ifdef CMSSW_GIT_HASH
+#include "UserUtils/Common/interface/SystemUtils/Command.hpp"
+#include "UserUtils/Common/interface/SystemUtils/Thread.hpp"
+#else
+#include "UserUtils/Common/SystemUtils/Command.hpp"
+#include "UserUtils/Common/SystemUtils/Thread.hpp"
+#endif
+
+#include <algorithm>
+
+namespace usr
+{
+
+/**
+ * @brief Number of workers to spawn for a given number of jobs.
+ *
+ * A requested thread count of 0 will default to the number of hardware threads
+ * available (see usr::NumOfThreads). The number of workers will never exceed
+ * the number of jobs, and will always be at least 1.
+ */
+unsigned
+WorkerCount( const unsigned nthreads, const size_t njobs )
+{
+  const unsigned request = nthreads == 0 ?
+                           NumOfThreads() :
+                           nthreads;
+  const size_t count = std::min( (size_t)std::max( request, 1u ), njobs );
+  return std::max( (unsigned)count, 1u );
+}
+
+}/* usr */
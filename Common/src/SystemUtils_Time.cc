@@ -5,7 +5,9 @@
  */
 
 #include <chrono>
+#include <cstdio>
 #include <ctime>
+#include <functional>
 #include <string>
 #include <thread>
 
@@ -127,4 +129,46 @@ SleepSec( const unsigned x )
   SleepFor<std::chrono::seconds>( x );
 }
 
+
+// Preventing the compiler from optimizing away the benchmarked calls.
+static volatile double bench_sink = 0;
+
+/**
+ * @brief Timing `calls` evaluations of a function and printing the result to
+ * standard output as a single line JSON object.
+ *
+ * The function is called once before the timing starts, so that one-time
+ * initializations (global caches, ROOT dictionaries) are not included in the
+ * per-call latency. The output line has the format:
+ *
+ * ```
+ * {"bench":"<name>","size":<size>,"calls":<calls>,"ns_per_call":...,"calls_per_sec":...}
+ * ```
+ */
+void
+RunBench( const std::string&             name,
+          const unsigned                 size,
+          const unsigned                 calls,
+          const std::function<double()>& func )
+{
+  bench_sink = func();
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for( unsigned i = 0; i < calls; ++i ){
+    bench_sink = bench_sink+func();
+  }
+
+  const auto   stop = std::chrono::steady_clock::now();
+  const double ns   = std::chrono::duration<double, std::nano>(
+    stop-start ).count();
+  const double ns_per_call = calls ? ns / calls : 0;
+
+  std::printf( "{\"bench\":\"%s\",\"size\":%u,\"calls\":%u,"
+               "\"ns_per_call\":%.1f,\"calls_per_sec\":%.1f}\n",
+               name.c_str(), size, calls,
+               ns_per_call, ns_per_call > 0 ? 1e9 / ns_per_call : 0 );
+  std::fflush( stdout );
+}
+
 }/* usr */
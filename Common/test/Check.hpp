@@ -0,0 +1,43 @@
+/**
+ * @file    Check.hpp
+ * @brief   Pass/fail reporting shared by the unit tests with explicit checks
+ * @author  [Yi-Mu "Enoch" Chen](https://github.com/yimuchen)
+ */
+#ifndef USERUTILS_COMMON_TEST_CHECK_HPP
+#define USERUTILS_COMMON_TEST_CHECK_HPP
+
+#include <iostream>
+#include <string>
+
+/**
+ * @brief Number of failed checks in the test program.
+ */
+inline unsigned&
+NumFailedChecks()
+{
+  static unsigned nfail = 0;
+  return nfail;
+}
+
+/**
+ * @brief Printing the result of a single check.
+ */
+inline void
+Check( const bool pass, const std::string& name )
+{
+  std::cout << ( pass ? "[PASS] " : "[FAIL] " ) << name << std::endl;
+  if( !pass ){ ++NumFailedChecks(); }
+}
+
+/**
+ * @brief Printing the number of failed checks, returning the exit code of the
+ * test program.
+ */
+inline int
+CheckSummary()
+{
+  std::cout << NumFailedChecks() << " checks failed" << std::endl;
+  return NumFailedChecks() ? 1 : 0;
+}
+
+#endif
@@ -14,6 +14,8 @@
 
 #include <boost/format.hpp>
 #include <iostream>
+#include <string>
+#include <vector>
 
 using namespace std;
 
@@ -47,9 +49,72 @@ testscientific( double x )
   cout << usr::separator() << endl;
 }
 
+/**
+ * @brief Comparing the output of usr::fstr with boost::format for a single
+ * argument, returning the number of mismatches.
+ */
+template<typename T>
+unsigned
+testfstr( const std::vector<std::string>& formats, const std::vector<T>& values )
+{
+  unsigned nfail = 0;
+
+  for( const auto& fmt : formats ){
+    for( const auto& x : values ){
+      const std::string fast = usr::fstr( fmt, x );
+      const std::string slow = boost::str( boost::format( fmt ) % x );
+      if( fast != slow ){
+        cout << "Mismatch for [" << fmt << "]: [" << fast << "] vs ["
+             << slow << "]" << endl;
+        ++nfail;
+      }
+    }
+  }
+
+  return nfail;
+}
+
 int
 main( int argc, char* argv[] )
 {
+  cout << usr::separator() << ">>> Fast fstr against boost::format" << endl;
+
+  const std::vector<std::string> intformats = {
+    "%d", "%5d", "%-5d|", "%+d", "%05d", "%+06d", "%u", "%i", "%s", "%8s",
+    "%f", "%g", "[%ld]", "%lld %%", "%.2d", "%1$d"
+  };
+  const std::vector<std::string> floatformats = {
+    "%f", "%.3f", "%10.2f", "%-10.2f|", "%+.2f", "%012.4f", "%+012.4f",
+    "%e", "%.3e", "%+.2E", "%g", "%.10g", "%G", "%s", "%d", "%12s"
+  };
+  const std::vector<std::string> strformats = {
+    "%s", "%10s", "%-10s|", "[%s] %%", "%d"
+  };
+
+  unsigned nfail = 0;
+  nfail += testfstr<int>( intformats, {0, 7, -7, 42, -123456, 2147483647} );
+  nfail += testfstr<unsigned>( intformats, {0u, 7u, 4294967295u} );
+  nfail += testfstr<long long>( intformats, {-9223372036854775807LL, 12LL} );
+  nfail += testfstr<double>( floatformats, {0., 3.14159265358979, -2.5e-7,
+                                            1e20, -1234.5678, 1.0/3.0} );
+  nfail += testfstr<float>( floatformats, {0.1f, -42.25f} );
+  nfail += testfstr<std::string>( strformats, {"", "abc", "longer string"} );
+  nfail += testfstr<const char*>( strformats, {"x", "hello world"} );
+
+  // Multiple arguments of mixed types
+  const std::string multi     = "%s: %5d/%-5u|%8.3f %e %%";
+  const std::string multifast = usr::fstr( multi, "run", -12, 34u, 2.71828, 1e-3 );
+  const std::string multislow = boost::str( boost::format( multi ) % "run"
+                                            % -12 % 34u % 2.71828 % 1e-3 );
+  if( multifast != multislow ){
+    cout << "Mismatch for [" << multi << "]: [" << multifast << "] vs ["
+         << multislow << "]" << endl;
+    ++nfail;
+  }
+
+  cout << nfail << " mismatches found" << endl;
+  if( nfail ){ return 1; }
+
   cout << usr::separator() << ">>> General decimal point testing" << endl;
 
   testdecimal( 123456789 );
@@ -0,0 +1,224 @@
+/**
+ * @file    logging.cc
+ * @brief   Testing the log writing backend with multiple threads
+ * @author  [Yi-Mu "Enoch" Chen](https://github.com/yimuchen)
+ */
+#ifdef CMSSW_GIT_HASH
+#include "UserUtils/Common/interface/STLUtils/OStreamUtils.hpp"
+#include "UserUtils/Common/interface/STLUtils/StringUtils.hpp"
+#else
+#include "UserUtils/Common/STLUtils/OStreamUtils.hpp"
+#include "UserUtils/Common/STLUtils/StringUtils.hpp"
+#endif
+
+#include "Check.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <exception>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+
+/**
+ * @brief Reading all lines of the log file.
+ */
+static std::vector<std::string>
+ReadLines( const std::string& filename )
+{
+  std::ifstream            file( filename );
+  std::vector<std::string> ans;
+  std::string              line;
+
+  while( std::getline( file, line ) ){
+    ans.push_back( line );
+  }
+
+  return ans;
+}
+
+
+/**
+ * @brief Generating logs from multiple threads, and checking that the log file
+ * contains every line exactly as generated, with the lines of each thread in
+ * order.
+ */
+static bool
+TestThreads( const std::string& filename,
+             const unsigned     nthreads,
+             const unsigned     nlines )
+{
+  std::ofstream( filename, std::ios::trunc ).close();
+  usr::log::AddLogFile( filename );
+
+  std::vector<std::thread> threads;
+
+  for( unsigned t = 0; t < nthreads; ++t ){
+    threads.emplace_back( [t, nlines](){
+      usr::log::SetThreadTag( usr::fstr( "thread%u", t ) );
+
+      for( unsigned i = 0; i < nlines; ++i ){
+        usr::log::PrintLog( usr::log::INFO,
+                            usr::fstr( "line %u of thread %u", i, t ),
+                            "[test]" );
+      }
+    } );
+  }
+
+  for( auto& thread : threads ){
+    thread.join();
+  }
+
+  usr::log::FlushLog();
+  usr::log::ClearLogFiles();
+
+  const std::vector<std::string> lines = ReadLines( filename );
+  std::vector<unsigned>          next( nthreads, 0 );
+  bool                           pass = lines.size() == nthreads * nlines;
+
+  for( const auto& line : lines ){
+    unsigned t1, t2, i;
+    char     end;
+    if( std::sscanf( line.c_str(), "[thread%u] [test] line %u of thread %u%c",
+                     &t1, &i, &t2, &end ) != 3
+        || t1 != t2 || t1 >= nthreads || i != next[t1] ){
+      cout << "Bad line: " << line << endl;
+      pass = false;
+      break;
+    }
+    ++next[t1];
+  }
+
+  return pass;
+}
+
+
+/**
+ * @brief Generating asynchronous logs, then terminating the program before the
+ * logs are flushed.
+ */
+static void
+RunTerminate( const std::string& filename )
+{
+  alarm( 30 );// Failing instead of hanging
+  usr::log::SetLogLevel( usr::log::INFO );
+  usr::log::SetLogAsync( true );
+  usr::log::AddLogFile( filename );
+
+  for( unsigned i = 0; i < 500; ++i ){
+    usr::log::PrintLog( usr::log::INFO, usr::fstr( "pending line %u", i ) );
+  }
+
+  std::terminate();
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+  if( argc == 3 && std::string( argv[1] ) == "terminate" ){
+    RunTerminate( argv[2] );
+  }
+
+  const std::string filename = usr::fstr( "/tmp/usrutil_logging_%d.log",
+                                          getpid() );
+  usr::log::SetLogLevel( usr::log::INFO );
+
+  // The bulk of the logs are not displayed on the terminal.
+  const int stderr_copy = dup( STDERR_FILENO );
+  const int devnull     = open( "/dev/null", O_WRONLY );
+  dup2( devnull, STDERR_FILENO );
+
+  usr::log::SetLogAsync( true );
+  Check( TestThreads( filename, 8, 2000 ),
+         "Asynchronous logs: no lost or interleaved lines, ordered per thread" );
+
+  usr::log::SetLogAsync( false );
+  Check( TestThreads( filename, 8, 500 ),
+         "Synchronous logs: no lost or interleaved lines, ordered per thread" );
+  usr::log::SetLogAsync( true );
+
+  // An ERROR log should be in the log file when PrintLog returns.
+  std::ofstream( filename, std::ios::trunc ).close();
+  usr::log::AddLogFile( filename );
+
+  for( unsigned i = 0; i < 100; ++i ){
+    usr::log::PrintLog( usr::log::INFO, usr::fstr( "pending line %u", i ) );
+  }
+
+  usr::log::PrintLog( usr::log::ERROR, "error message" );
+  {
+    const std::vector<std::string> lines = ReadLines( filename );
+    Check( lines.size() == 101 && lines.back() == "error message",
+           "ERROR log written to file before PrintLog returns" );
+  }
+  usr::log::ClearLogFiles();
+
+  // A FATAL log should be in the log file before the exception is raised.
+  std::ofstream( filename, std::ios::trunc ).close();
+  usr::log::AddLogFile( filename );
+
+  for( unsigned i = 0; i < 100; ++i ){
+    usr::log::PrintLog( usr::log::INFO, usr::fstr( "pending line %u", i ) );
+  }
+
+  bool fatal_written = false;
+
+  try {
+    usr::log::PrintLog( usr::log::FATAL, "fatal message" );
+  } catch( std::runtime_error& ){
+    const std::vector<std::string> lines = ReadLines( filename );
+    fatal_written = lines.size() == 101 && lines.back() == "fatal message";
+  }
+
+  usr::log::ClearLogFiles();
+  Check( fatal_written, "FATAL log written to file before exception" );
+
+  // Pending logs should be written if the program is terminated. The writer
+  // thread doesn't exist in a forked child, so the test program is executed
+  // again in the terminate mode.
+  std::ofstream( filename, std::ios::trunc ).close();
+  const pid_t tpid = fork();
+  if( tpid == 0 ){
+    execl( "/proc/self/exe", argv[0], "terminate", filename.c_str(), nullptr );
+    _exit( 1 );
+  }
+  int tstatus = 0;
+  waitpid( tpid, &tstatus, 0 );
+  Check( WIFSIGNALED( tstatus ) && WTERMSIG( tstatus ) == SIGABRT
+         && ReadLines( filename ).size() == 500,
+         "Pending logs written on std::terminate" );
+
+  // Logs in a forked child process, more than the size of the log buffer.
+  usr::log::PrintLog( usr::log::INFO, "parent log before fork" );
+  const pid_t pid = fork();
+  if( pid == 0 ){
+    alarm( 30 );// Failing instead of hanging
+
+    for( unsigned i = 0; i < 4096; ++i ){
+      usr::log::PrintLog( usr::log::INFO, usr::fstr( "child line %u", i ) );
+    }
+
+    usr::log::FlushLog();
+    std::exit( 0 );
+  }
+  int status = 0;
+  waitpid( pid, &status, 0 );
+  Check( WIFEXITED( status ) && WEXITSTATUS( status ) == 0,
+         "Logs in forked child process" );
+
+  usr::log::FlushLog();
+  dup2( stderr_copy, STDERR_FILENO );
+  std::remove( filename.c_str() );
+
+  return CheckSummary();
+}
@@ -0,0 +1,100 @@
+/**
+ * @file    progress.cc
+ * @brief   Testing the progress reporter together with logs from many threads
+ * @author  [Yi-Mu "Enoch" Chen](https://github.com/yimuchen)
+ *
+ * When run on a terminal, the progress line should be kept at the bottom of
+ * the terminal, with the log lines scrolling above it. The STDERR output is
+ * also captured to a file for a run, where every line should either be a
+ * complete log line or a complete progress line.
+ */
+#ifdef CMSSW_GIT_HASH
+#include "UserUtils/Common/interface/STLUtils/OStreamUtils.hpp"
+#include "UserUtils/Common/interface/STLUtils/StringUtils.hpp"
+#include "UserUtils/Common/interface/SystemUtils/Thread.hpp"
+#else
+#include "UserUtils/Common/STLUtils/OStreamUtils.hpp"
+#include "UserUtils/Common/STLUtils/StringUtils.hpp"
+#include "UserUtils/Common/SystemUtils/Thread.hpp"
+#endif
+
+#include "Check.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+
+/**
+ * @brief Running a loop over multiple threads, with a log line generated for
+ * every few steps.
+ */
+static void
+RunLoop( const size_t total, const unsigned sleep_us )
+{
+  usr::ProgressReporter progress( "Processing", total, 0.05 );
+  usr::ParallelFor( total, 4, [&]( const size_t i, const unsigned w ){
+    usr::log::SetThreadTag( usr::fstr( "worker%u", w ) );
+    std::this_thread::sleep_for( std::chrono::microseconds( sleep_us ) );
+    if( i % 50 == 0 ){
+      usr::log::PrintLog( usr::log::INFO, usr::fstr( "step %u", i ) );
+    }
+    progress.Add();
+  } );
+  progress.Finish();
+  usr::log::FlushLog();
+}
+
+
+int
+main( int argc, char* argv[] )
+{
+  usr::log::SetLogLevel( usr::log::INFO );
+
+  // Displaying on the terminal.
+  RunLoop( 1000, 2000 );
+
+  // Capturing STDERR to a file.
+  const std::string filename = usr::fstr( "/tmp/usrutil_progress_%d.log",
+                                          getpid() );
+  const int stderr_copy = dup( STDERR_FILENO );
+  const int capture     = open( filename.c_str(),
+                                O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+  dup2( capture, STDERR_FILENO );
+  RunLoop( 1000, 100 );
+  dup2( stderr_copy, STDERR_FILENO );
+  close( capture );
+
+  std::ifstream file( filename );
+  std::string   line;
+  unsigned      nlog      = 0;
+  unsigned      nprogress = 0;
+  bool          pass      = true;
+
+  while( std::getline( file, line ) ){
+    unsigned w, i;
+    char     end;
+    if( std::sscanf( line.c_str(), "[worker%u] step %u%c", &w, &i, &end ) == 2 ){
+      ++nlog;
+    } else if( line.rfind( "[Processing] ", 0 ) == 0
+               && line.find( '[', 1 ) == std::string::npos ){
+      ++nprogress;
+    } else {
+      cout << "Bad line: [" << line << "]" << endl;
+      pass = false;
+    }
+  }
+
+  std::remove( filename.c_str() );
+
+  cout << nlog << " log lines, " << nprogress << " progress lines" << endl;
+  Check( pass && nlog == 20 && nprogress >= 1,
+         "Progress and log lines are not interleaved" );
+  return CheckSummary();
+}
@@ -0,0 +1,100 @@
+/**
+ * @file    rooargcontainer.cc
+ * @brief   Testing the RooArgContainer look up and the custom command registry
+ * @author  [Yi-Mu "Enoch" Chen](https://github.com/yimuchen)
+ */
+#ifdef CMSSW_GIT_HASH
+#include "UserUtils/Common/interface/RootUtils/RooArgContainer.hpp"
+#include "UserUtils/Common/interface/STLUtils/VectorUtils.hpp"
+#else
+#include "UserUtils/Common/RootUtils/RooArgContainer.hpp"
+#include "UserUtils/Common/STLUtils/VectorUtils.hpp"
+#endif
+
+#include "Check.hpp"
+
+#include <RooLinkedList.h>
+
+#include <algorithm>
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+RooCmdArg
+TestCmdA( const int i ){ return RooCmdArg( "TestCmdA", i ); }
+
+USERUTILS_COMMON_REGISTERCMD( TestCmdA );
+
+RooCmdArg
+TestCmdB( const int i ){ return RooCmdArg( "TestCmdB", i ); }
+
+USERUTILS_COMMON_REGISTERCMD( TestCmdB );
+
+
+int
+main( int argc, char* argv[] )
+{
+  // Registration and look up of custom commands
+  Check( usr::RooArgContainer::IsCustomCommand( "TestCmdA" ),
+         "TestCmdA is registered" );
+  Check( usr::RooArgContainer::IsCustomCommand( "TestCmdB" ),
+         "TestCmdB is registered" );
+  Check( !usr::RooArgContainer::IsCustomCommand( "TestCmdC" ),
+         "TestCmdC is not registered" );
+  Check( usr::FindValue( usr::RooArgContainer::CustomCommandList(),
+                         std::string( "TestCmdA" ) ),
+         "TestCmdA in CustomCommandList()" );
+
+  const std::vector<std::string> sorted = usr::RooArgContainer::CustomCommands();
+  Check( sorted.size() == usr::RooArgContainer::CustomCommandList().size()
+         && std::is_sorted( sorted.begin(), sorted.end() ),
+         "CustomCommands is the sorted list of registered commands" );
+
+  const size_t nregistered = usr::RooArgContainer::CustomCommandList().size();
+  Check( usr::RooArgContainer::RegistorCommand( "TestCmdC" ) == nregistered+1
+         && usr::RooArgContainer::IsCustomCommand( "TestCmdC" )
+         && usr::RooArgContainer::CustomCommandList().back() == "TestCmdC",
+         "Run time registration of TestCmdC" );
+
+#ifndef NDEBUG
+  // Registering a duplicate name should fail the assertion, this is done in a
+  // child process so that the test can continue.
+  const pid_t pid = fork();
+  if( pid == 0 ){
+    close( STDERR_FILENO );
+    usr::RooArgContainer::RegistorCommand( "TestCmdA" );
+    _exit( 0 );
+  }
+  int status = 0;
+  waitpid( pid, &status, 0 );
+  Check( WIFSIGNALED( status ), "Duplicate registration is rejected" );
+#endif
+  Check( usr::RooArgContainer::CustomCommandList().size() == nregistered+1,
+         "Registry unchanged by duplicate registration" );
+
+  // Argument look up, and the exclusion of custom commands when passing the
+  // arguments to RooFit.
+  usr::RooArgContainer args( { TestCmdA( 1 ), RooCmdArg( "Native", 2 ),
+                               TestCmdA( 3 ) },
+                             { TestCmdB( 4 ), RooCmdArg( "Native", 5 ) } );
+  Check( args.size() == 3, "Duplicate arguments are removed" );
+  Check( args.GetInt( "TestCmdA" ) == 1 && args.GetInt( "Native" ) == 2
+         && args.GetInt( "TestCmdB" ) == 4,
+         "First instance of arguments are kept" );
+  Check( args.MakeRooList().GetSize() == 1,
+         "Custom commands excluded from RooLinkedList" );
+
+  // Modifying the container after construction
+  args.erase( args.begin() );
+  args.push_back( RooCmdArg( "Extra", 6 ) );
+  Check( !args.Has( "TestCmdA" ) && args.Has( "Extra" )
+         && args.GetInt( "Extra" ) == 6 && args.GetInt( "TestCmdB" ) == 4,
+         "Look up after same-size modification" );
+  args[0] = RooCmdArg( "Replaced", 7 );
+  Check( !args.Has( "Native" ) && args.GetInt( "Replaced" ) == 7,
+         "Look up after element replacement" );
+
+  return CheckSummary();
+}
@@ -13,9 +13,18 @@
 
 #include <vector>
 #include <iostream>
+#include <list>
+#include <utility>
 
 using namespace std;
 
+template<size_t ... I>
+vector<int>
+MakeLargeVector( std::index_sequence<I...> )
+{
+  return usr::MakeVector<int>( int(I) ... );
+}
+
 int
 main( int argc, char const* argv[] )
 {
@@ -29,6 +38,31 @@ main( int argc, char const* argv[] )
     cout << x << endl;
   }
 
+  // Large argument packs
+  vector<int> large = MakeLargeVector( std::make_index_sequence<512>() );
+  cout << large.size() << " " << large.capacity() << endl;
+  for( size_t i = 0; i < large.size(); ++i ){
+    if( large[i] != int(i) ){
+      cout << "Mismatch at index " << i << endl;
+      return 1;
+    }
+  }
+
+  // Mixing scalars and containers
+  vector<double> mix = usr::MakeVector<double>( 1, vector<int>{2, 3},
+                                                4.5, list<float>{5, 6}, 7 );
+  for( auto x : mix ){
+    cout << x << " ";
+  }
+  cout << endl;
+
+  vector<string> strs = usr::MakeVector<string>( "a", string( "b" ),
+                                                 vector<string>{"c","d"} );
+  for( auto x : strs ){
+    cout << x << " ";
+  }
+  cout << endl;
+
   cout << usr::fstr( "this is a test" ) << std::endl;
   cout << usr::fstr( "My test %d\n", 1234) << std::endl;
 
@@ -0,0 +1,206 @@
+/**
+ * @file    mathutils_bench.cc
+ * @brief   Micro-benchmarks of the computationally intensive MathUtils routines
+ * @author  [Yi-Mu "Enoch" Chen](https://github.com/yimuchen)
+ *
+ * Each benchmark is evaluated on synthetic inputs generated from a fixed seed,
+ * with the size of the input configurable from the command line. The results
+ * are printed to standard output as one JSON object per line, so the outputs
+ * of different revisions of the library can be compared directly:
+ *
+ * ```
+ * {"bench":"measurement_sum","size":16,"calls":1000,"ns_per_call":...,"calls_per_sec":...}
+ * ```
+ */
+#ifdef CMSSW_GIT_HASH
+#include "UserUtils/Common/interface/ArgumentExtender.hpp"
+#include "UserUtils/Common/interface/SystemUtils/Time.hpp"
+#include "UserUtils/MathUtils/interface/Measurement.hpp"
+#include "UserUtils/MathUtils/interface/RooFitExt.hpp"
+#include "UserUtils/MathUtils/interface/RootMathTools/TemplateFit.hpp"
+#include "UserUtils/MathUtils/interface/StatisticsUtil.hpp"
+#else
+#include "UserUtils/Common/ArgumentExtender.hpp"
+#include "UserUtils/Common/SystemUtils/Time.hpp"
+#include "UserUtils/MathUtils/Measurement.hpp"
+#include "UserUtils/MathUtils/RooFitExt.hpp"
+#include "UserUtils/MathUtils/RootMathTools/TemplateFit.hpp"
+#include "UserUtils/MathUtils/StatisticsUtil.hpp"
+#endif
+
+#include "RooDataSet.h"
+#include "RooGaussian.h"
+#include "RooMsgService.h"
+#include "RooRandom.h"
+#include "RooRealVar.h"
+#include "TH1D.h"
+#include "TRandom3.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Synthetic list of measurements with positive central values and
+ * asymmetric uncertainties.
+ */
+static std::vector<usr::Measurement>
+MakeMeasurements( const unsigned size, TRandom3& rand )
+{
+  std::vector<usr::Measurement> ans;
+  ans.reserve( size );
+
+  for( unsigned i = 0; i < size; ++i ){
+    const double c = rand.Uniform( 1, 10 );
+    ans.emplace_back( c,
+      c * rand.Uniform( 0.01, 0.1 ),
+      c * rand.Uniform( 0.01, 0.1 ) );
+  }
+
+  return ans;
+}
+
+
+/*-----------------------------------------------------------------------------
+ *  Main function
+   --------------------------------------------------------------------------*/
+int
+main( int argc, char** argv )
+{
+  usr::po::options_description desc( "Benchmark options" );
+  desc.add_options()
+    ( "size,s", usr::po::defvalue<unsigned>( 16 ),
+    "Size of the synthetic input (number of measurements, number of bins, "
+    "number of events per 100)" )
+    ( "calls,n", usr::po::defvalue<unsigned>( 1000 ),
+    "Number of timed calls per benchmark" )
+    ( "seed", usr::po::defvalue<unsigned>( 42 ),
+    "Random seed for the synthetic inputs" )
+    ( "filter,f", usr::po::defvalue<std::string>( "" ),
+    "Only run benchmarks whose name contains this string" )
+  ;
+
+  usr::ArgumentExtender args;
+  args.AddOptions( desc );
+  args.ParseOptions( argc, argv );
+
+  const unsigned    size   = std::max( args.Arg<unsigned>( "size" ), 1u );
+  const unsigned    calls  = args.Arg<unsigned>( "calls" );
+  const unsigned    seed   = args.Arg<unsigned>( "seed" );
+  const std::string filter = args.Arg<std::string>( "filter" );
+
+  auto Run = [&]( const std::string& name,
+                  const unsigned nc,
+                  const std::function<double()>& func ){
+               if( name.find( filter ) != std::string::npos ){
+                 usr::RunBench( name, size, nc, func );
+               }
+             };
+
+  RooMsgService::instance().setGlobalKillBelow( RooFit::WARNING );
+  TRandom3 rand( seed );
+
+  // Measurement arithmetics
+  const std::vector<usr::Measurement> mlist = MakeMeasurements( size, rand );
+
+  Run( "measurement_sum", calls, [&]{
+    return usr::SumUncorrelated( mlist ).CentralValue();
+  } );
+  Run( "measurement_prod", calls, [&]{
+    return usr::ProdUncorrelated( mlist ).CentralValue();
+  } );
+
+  // Minos error of a single variable NLL function
+  const usr::stat::GaussianNLL gausnll( 1.0, 0.5 );
+  Run( "minos_1d", calls, [&]{
+    return usr::MakeMinos( gausnll, -10, 10 ).AbsUpperError();
+  } );
+
+  // Template fit objective function and gradient
+  TH1D t1( "t1", "", size, -10, 10 );
+  TH1D t2( "t2", "", size, -10, 10 );
+  TH1D target( "target", "", size, -10, 10 );
+
+  for( unsigned i = 0; i < 100 * size; ++i ){
+    t1.Fill( rand.Gaus( -2, 1 ) );
+    t2.Fill( rand.Gaus( 2, 1.5 ) );
+    target.Fill( rand.Uniform() < 0.5 ? rand.Gaus( -2, 1 ) :
+                 rand.Gaus( 2, 1.5 ) );
+  }
+
+  const std::vector<TH1*> templates = {&t1, &t2};
+  const usr::TemplateFit  chi2fit( &target, templates, false );
+  const usr::TemplateFit  bbfit( &target, templates, false,
+                                 usr::TemplateFit::BBLITE );
+  const double fitpar[2] = {
+    target.Integral() * 0.4 / t1.Integral(),
+    target.Integral() * 0.6 / t2.Integral()};
+  double grad[2];
+
+  Run( "templatefit_eval_chi2", calls, [&]{ return chi2fit( fitpar ); } );
+  Run( "templatefit_eval_bblite", calls, [&]{ return bbfit( fitpar ); } );
+  Run( "templatefit_gradient", calls, [&]{
+    chi2fit.Gradient( fitpar, grad );
+    return grad[0];
+  } );
+
+  // KS distance of dataset against PDF, and of two datasets. The number of
+  // timed calls is reduced as each call scales with the number of events.
+  RooRealVar  x( "x", "x", -10, 10 );
+  RooRealVar  m( "m", "m", 0, -5, 5 );
+  RooRealVar  s( "s", "s", 2, 0.1, 5 );
+  RooGaussian g( "g", "g", x, m, s );
+  RooRandom::randomGenerator()->SetSeed( seed );
+  std::unique_ptr<RooDataSet> set1( g.generate( RooArgSet( x ), 100 * size ) );
+  std::unique_ptr<RooDataSet> set2( g.generate( RooArgSet( x ), 100 * size ) );
+  const unsigned kscalls = std::max( calls / 100, 1u );
+
+  Run( "ksdistance_pdf", kscalls, [&]{
+    return usr::KSDistance( *set1, g, x );
+  } );
+  Run( "ksdistance_data", kscalls, [&]{
+    return usr::KSDistance( *set1, *set2, x );
+  } );
+
+  // Interval construction, with the interval cache disabled and enabled. The
+  // inputs cycle through `size` distinct integer values.
+  std::vector<double> passed( size );
+  std::vector<double> total( size );
+
+  for( unsigned i = 0; i < size; ++i ){
+    total[i]  = rand.Integer( 1000 )+1;
+    passed[i] = rand.Integer( total[i]+1 );
+  }
+
+  for( const bool cached : {false, true} ){
+    const std::string tag = cached ? "_cached" : "_uncached";
+    usr::IntervalCache::Clear();
+    usr::IntervalCache::SetMaxEntries( cached ? ( 1 << 16 ) : 0 );
+    unsigned idx = 0;
+
+    Run( "efficiency_clopperpearson"+tag, calls, [&]{
+      idx = ( idx+1 ) % size;
+      return usr::Efficiency::ClopperPearson( passed[idx], total[idx] )
+             .CentralValue();
+    } );
+    Run( "efficiency_bayesian"+tag, calls, [&]{
+      idx = ( idx+1 ) % size;
+      return usr::Efficiency::Bayesian( passed[idx], total[idx] )
+             .CentralValue();
+    } );
+    Run( "poisson_minos"+tag, calls, [&]{
+      idx = ( idx+1 ) % size;
+      return usr::Poisson::Minos( passed[idx] ).CentralValue();
+    } );
+    Run( "poisson_cmsstatcom"+tag, calls, [&]{
+      idx = ( idx+1 ) % size;
+      return usr::Poisson::CMSStatCom( passed[idx] ).CentralValue();
+    } );
+  }
+
+  usr::IntervalCache::SetMaxEntries( 1 << 16 );
+
+  return 0;
+}
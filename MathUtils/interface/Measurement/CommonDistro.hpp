@@ -71,6 +71,18 @@ extern Measurement CMSStatCom(
 
 };// Poisson
 
+
+/*-----------------------------------------------------------------------------
+ *  Control of the cached intervals of the Efficiency and Poisson measurements
+   --------------------------------------------------------------------------*/
+namespace IntervalCache
+{
+extern void   Clear();
+extern void   SetMaxEntries( const size_t );
+extern size_t Size();
+
+};// IntervalCache
+
 }/* usr */
 
 #endif/* end of include guard: USERUTILS_MATHUTILS_EFFICIENCY_HPP */
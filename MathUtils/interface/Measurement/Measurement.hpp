@@ -8,6 +8,8 @@
 
 namespace usr {
 
+struct MeasurementPOD;
+
 /**
  * @brief Class for containing a measurement with asymmetric uncertainties as
  *        well as performing basic arithmetics with quick-and-dirty uncertainty
@@ -24,6 +26,7 @@ public:
   Measurement( const double central,
                const double error );
   Measurement( const Measurement& );
+  Measurement( const MeasurementPOD& );
 
   virtual ~Measurement ();
 
@@ -87,6 +90,162 @@ private:
   double _error_down;
 };
 
+/**
+ * @brief Trivially copyable counterpart of the usr::Measurement class.
+ *        Collection of measurements can be stored densely, copied with
+ *        memcpy and passed between threads without any overhead.
+ * @ingroup StatUtils
+ *
+ * The object holds the same three numbers as the usr::Measurement class,
+ * without the virtual table pointer or the implicit conversion to double.
+ * Arithmetics with plain numbers are evaluated inline (and can be used in
+ * constexpr contexts), while the arithmetics between two measurements is
+ * passed to the usr::Measurement routines, so the two classes give identical
+ * results. Unlike the usr::Measurement constructor, negative uncertainties are
+ * flipped silently.
+ *
+ * The conversion from usr::Measurement is explicit, so that only the
+ * conversion to usr::Measurement is implicit. Arithmetics between the two
+ * classes are evaluated as usr::Measurement arithmetics.
+ */
+struct MeasurementPOD
+{
+  double central;
+  double error_up;
+  double error_down;
+
+  MeasurementPOD() = default;
+  constexpr MeasurementPOD( const double c,
+                            const double up,
+                            const double down ) :
+    central   ( c ),
+    error_up  ( up < 0 ? -up : up ),
+    error_down( down < 0 ? -down : down ){}
+  constexpr MeasurementPOD( const double c, const double err ) :
+    MeasurementPOD( c, err, err ){}
+  explicit MeasurementPOD( const Measurement& x ) :
+    central   ( x.CentralValue() ),
+    error_up  ( x.AbsUpperError() ),
+    error_down( x.AbsLowerError() ){}
+
+  // Basic access functions, same as usr::Measurement
+  inline constexpr double
+  CentralValue()  const { return central; }
+  inline constexpr double
+  AbsUpperError() const { return error_up; }
+  inline constexpr double
+  AbsLowerError() const { return error_down; }
+  inline constexpr double
+  AbsAvgError()   const { return ( error_up+error_down ) / 2; }
+  inline constexpr double
+  RelUpperError() const { return error_up / central; }
+  inline constexpr double
+  RelLowerError() const { return error_down / central; }
+  inline constexpr double
+  RelAvgError()   const { return ( RelUpperError()+RelLowerError() ) / 2.; }
+  inline constexpr double
+  UpperValue()    const { return central+error_up; }
+  inline constexpr double
+  LowerValue()    const { return central-error_down; }
+
+  inline constexpr MeasurementPOD
+  NormParam() const
+  { return MeasurementPOD( 1, RelUpperError(), RelLowerError() ); }
+
+  // Measurement-Measurement arithmetics, see src/Measurement.cc
+  MeasurementPOD& operator+=( const MeasurementPOD& );
+  MeasurementPOD& operator-=( const MeasurementPOD& );
+  MeasurementPOD& operator*=( const MeasurementPOD& );
+  MeasurementPOD& operator/=( const MeasurementPOD& );
+
+  MeasurementPOD operator+( const MeasurementPOD& ) const;
+  MeasurementPOD operator-( const MeasurementPOD& ) const;
+  MeasurementPOD operator*( const MeasurementPOD& ) const;
+  MeasurementPOD operator/( const MeasurementPOD& ) const;
+
+  // Measurement-double arithmetics
+  inline constexpr MeasurementPOD&
+  operator+=( const double x ){ central += x; return *this; }
+  inline constexpr MeasurementPOD&
+  operator-=( const double x ){ central -= x; return *this; }
+  inline constexpr MeasurementPOD&
+  operator*=( const double x )
+  {
+    central    *= x;
+    error_up   *= x < 0 ? -x : x;
+    error_down *= x < 0 ? -x : x;
+    return *this;
+  }
+  inline constexpr MeasurementPOD&
+  operator/=( const double x )
+  {
+    central    /= x;
+    error_up   /= x < 0 ? -x : x;
+    error_down /= x < 0 ? -x : x;
+    return *this;
+  }
+
+  inline constexpr MeasurementPOD
+  operator+( const double x ) const { return MeasurementPOD( *this ) += x; }
+  inline constexpr MeasurementPOD
+  operator-( const double x ) const { return MeasurementPOD( *this ) -= x; }
+  inline constexpr MeasurementPOD
+  operator*( const double x ) const { return MeasurementPOD( *this ) *= x; }
+  inline constexpr MeasurementPOD
+  operator/( const double x ) const { return MeasurementPOD( *this ) /= x; }
+};
+
+inline constexpr MeasurementPOD
+operator+( const double y, const MeasurementPOD& x ){ return x+y; }
+
+inline constexpr MeasurementPOD
+operator-( const double y, const MeasurementPOD& x )
+{ return MeasurementPOD( y-x.central, x.error_down, x.error_up ); }
+
+inline constexpr MeasurementPOD
+operator*( const double y, const MeasurementPOD& x ){ return x * y; }
+
+inline constexpr MeasurementPOD
+operator/( const double y, const MeasurementPOD& x )
+{
+  return MeasurementPOD( y / x.central,
+    y / x.central * x.RelUpperError(),
+    y / x.central * x.RelLowerError() );
+}
+
+// Mixed Measurement-MeasurementPOD arithmetics
+inline Measurement
+operator+( const Measurement& x, const MeasurementPOD& y )
+{ return x+Measurement( y ); }
+
+inline Measurement
+operator-( const Measurement& x, const MeasurementPOD& y )
+{ return x-Measurement( y ); }
+
+inline Measurement
+operator*( const Measurement& x, const MeasurementPOD& y )
+{ return x * Measurement( y ); }
+
+inline Measurement
+operator/( const Measurement& x, const MeasurementPOD& y )
+{ return x / Measurement( y ); }
+
+inline Measurement
+operator+( const MeasurementPOD& x, const Measurement& y )
+{ return Measurement( x )+y; }
+
+inline Measurement
+operator-( const MeasurementPOD& x, const Measurement& y )
+{ return Measurement( x )-y; }
+
+inline Measurement
+operator*( const MeasurementPOD& x, const Measurement& y )
+{ return Measurement( x ) * y; }
+
+inline Measurement
+operator/( const MeasurementPOD& x, const Measurement& y )
+{ return Measurement( x ) / y; }
+
 }/* usr */
 
 
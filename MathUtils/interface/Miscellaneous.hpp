@@ -10,6 +10,8 @@
 #include "TH1.h"
 #include "TMatrixD.h"
 #include "TMatrixDSym.h"
+#include "TRandom.h"
+#include "TVectorD.h"
 
 namespace usr
 {
@@ -32,6 +34,13 @@ extern bool Intersect( const double p1x,
                        double&      inty );
 
 extern TMatrixD DecompCorvariance( const TMatrixDSym& m );
+extern TMatrixD SampleCorrelatedGaussian( const TVectorD&    mean,
+                                          const TMatrixDSym& cov,
+                                          const unsigned     nsamples,
+                                          TRandom&           rand );
+extern TMatrixD SampleCorrelatedGaussian( const TVectorD&    mean,
+                                          const TMatrixDSym& cov,
+                                          const unsigned     nsamples );
 
 extern double GetEffectiveEvents( const TH1&, const int );
 extern double GetEffectiveEvents( const TH1*, const int );
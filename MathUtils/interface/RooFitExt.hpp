@@ -42,13 +42,15 @@ extern double KSDistance( RooDataSet&      dataset,
                           RooAbsPdf&       pdf,
                           RooRealVar&      var,
                           const RooCmdArg& cut1 = RooCmdArg::none(),
-                          const RooCmdArg& cut2 = RooCmdArg::none());
+                          const RooCmdArg& cut2 = RooCmdArg::none(),
+                          const RooCmdArg& arg3 = RooCmdArg::none());
 
 extern double KSProb( RooDataSet&      dataset,
                       RooAbsPdf&       pdf,
                       RooRealVar&      var,
                       const RooCmdArg& cut1 = RooCmdArg::none(),
-                      const RooCmdArg& cut2 = RooCmdArg::none());
+                      const RooCmdArg& cut2 = RooCmdArg::none(),
+                      const RooCmdArg& arg3 = RooCmdArg::none());
 
 extern double KSDistance( RooDataSet&      set1,
                           RooDataSet&      set2,
@@ -68,6 +70,64 @@ extern double KSProbAlt( RooDataSet&      set1,
                          const RooCmdArg& cut1 = RooCmdArg::none(),
                          const RooCmdArg& cut2 = RooCmdArg::none());
 
+RooCmdArg NumToys( const unsigned n, const unsigned seed = 0 );
+RooCmdArg RefitToys( const bool x = true );
+RooCmdArg KSTolerance( const double x );
+
+/**
+ * @{
+ * @brief KS test p-value evaluated from pseudo-experiments
+ */
+extern Measurement KSToyProb( RooDataSet&                   dataset,
+                              RooAbsPdf&                    pdf,
+                              RooRealVar&                   var,
+                              const std::vector<RooCmdArg>& cmdargs );
+
+inline Measurement
+KSToyProb( RooDataSet& dataset, RooAbsPdf& pdf, RooRealVar& var )
+{
+  return KSToyProb( dataset, pdf, var, {} );
+}
+
+
+template<typename ... Args>
+inline Measurement
+KSToyProb( RooDataSet&      dataset,
+           RooAbsPdf&       pdf,
+           RooRealVar&      var,
+           const RooCmdArg& arg1,
+           Args ... args )
+{
+  return KSToyProb( dataset, pdf, var, MakeVector<RooCmdArg>( arg1, args ... ) );
+}
+
+
+extern Measurement KSToyProb( RooDataSet&                   set1,
+                              RooDataSet&                   set2,
+                              RooRealVar&                   var,
+                              const std::vector<RooCmdArg>& cmdargs );
+
+inline Measurement
+KSToyProb( RooDataSet& set1, RooDataSet& set2, RooRealVar& var )
+{
+  return KSToyProb( set1, set2, var, {} );
+}
+
+
+template<typename ... Args>
+inline Measurement
+KSToyProb( RooDataSet&      set1,
+           RooDataSet&      set2,
+           RooRealVar&      var,
+           const RooCmdArg& arg1,
+           Args ... args )
+{
+  return KSToyProb( set1, set2, var, MakeVector<RooCmdArg>( arg1, args ... ) );
+}
+
+
+/** @} */
+
 /* @} */
 
 /**
@@ -113,6 +173,21 @@ FitPDFToData( RooAbsPdf&        pdf,
 
 RooCmdArg MaxFitIteration( unsigned x );
 
+/**
+ * @brief Enum for specifying how the initial parameters of multi-start fits
+ * are sampled.
+ */
+enum multistart
+{
+  multistart_perturb = 0,// < Gaussian perturbation around the present values
+  multistart_grid    = 1// < Regular grid across the parameter ranges
+};
+
+RooCmdArg MultiStart( const unsigned npoints,
+                      const int      mode = multistart_perturb,
+                      const unsigned seed = 0 );
+RooCmdArg NumThreads( const unsigned n );
+
 /**
  * @{
  * @brief Running the Fit Routine until converge or pass certain amount of fit
@@ -8,9 +8,11 @@
 #ifdef CMSSW_GIT_HASH
 #include "UserUtils/Common/interface/RootUtils/RooArgContainer.hpp"
 #include "UserUtils/Common/interface/STLUtils/VectorUtils.hpp"
+#include "UserUtils/MathUtils/interface/RooFitExt.hpp"
 #else
 #include "UserUtils/Common/RootUtils/RooArgContainer.hpp"
 #include "UserUtils/Common/STLUtils/VectorUtils.hpp"
+#include "UserUtils/MathUtils/RooFitExt.hpp"
 #endif
 
 #include "TF1.h"
@@ -18,6 +20,9 @@
 #include "TGraph.h"
 #include "TH1.h"
 
+#include <utility>
+#include <vector>
+
 namespace usr
 {
 
@@ -50,6 +55,77 @@ inline TFitResult FitGraph( TGraph&          g,
 
 /** @} */
 
+/**
+ * @brief Results of a scan of graph fits, with one entry per scan point.
+ */
+struct ScanResult
+{
+  std::vector<double> x;// < Scanned parameter value (or fit range center)
+  std::vector<double> fcn;// < Minimum value of the fit objective function
+  std::vector<int> status;// < Fit status (0 for converged fits)
+  std::vector<std::vector<double> > param;// < Fitted parameter values
+  std::vector<std::vector<double> > error;// < Fitted parameter uncertainties
+
+  TGraph* MakeGraph( const bool subtract_min = true ) const;
+  TGraph* MakeParamGraph( const unsigned ipar ) const;
+};
+
+/**
+ * @{
+ * @brief Scanning graph fits over fixed values of a function parameter.
+ */
+extern ScanResult ScanGraphParam( TGraph&,
+                                  TF1&,
+                                  const unsigned               ipar,
+                                  const std::vector<double>&   values,
+                                  const std::vector<RooCmdArg>& );
+inline ScanResult ScanGraphParam( TGraph&                    g,
+                                  TF1&                       f,
+                                  const unsigned             ipar,
+                                  const std::vector<double>& values )
+{ return ScanGraphParam( g, f, ipar, values, std::vector<RooCmdArg>() ); }
+template<typename ... Args>
+inline ScanResult ScanGraphParam( TGraph&                    g,
+                                  TF1&                       f,
+                                  const unsigned             ipar,
+                                  const std::vector<double>& values,
+                                  const RooCmdArg&           arg1,
+                                  Args ... args )
+{
+  return ScanGraphParam( g, f, ipar, values,
+                         MakeVector<RooCmdArg>( arg1, args ... ) );
+}
+
+/** @} */
+
+/**
+ * @{
+ * @brief Scanning graph fits over a list of fit ranges.
+ */
+extern ScanResult ScanGraphRange(
+  TGraph&,
+  TF1&,
+  const std::vector<std::pair<double, double> >& ranges,
+  const std::vector<RooCmdArg>& );
+inline ScanResult ScanGraphRange(
+  TGraph&                                        g,
+  TF1&                                           f,
+  const std::vector<std::pair<double, double> >& ranges )
+{ return ScanGraphRange( g, f, ranges, std::vector<RooCmdArg>() ); }
+template<typename ... Args>
+inline ScanResult ScanGraphRange(
+  TGraph&                                        g,
+  TF1&                                           f,
+  const std::vector<std::pair<double, double> >& ranges,
+  const RooCmdArg&                               arg1,
+  Args ... args )
+{
+  return ScanGraphRange( g, f, ranges,
+                         MakeVector<RooCmdArg>( arg1, args ... ) );
+}
+
+/** @} */
+
 
 enum verbose
 {
@@ -13,6 +13,7 @@
 #endif
 
 #include "Math/Functor.h"
+#include "Math/IFunction.h"
 #include "Math/Minimizer.h"
 #include "TH1.h"
 
@@ -20,18 +21,28 @@
 
 namespace usr {
 
-class TemplateFit : public ROOT::Math::IMultiGenFunction
+class TemplateFit : public ROOT::Math::IMultiGradFunction
 {
 public:
+  /**
+   * @brief Objective function to minimize.
+   */
+  enum objective
+  {
+    CHI2 = 0, BBLITE = 1
+  };
+
   static
   std::vector<Measurement> SimpleFit( const TH1*               target,
                                       const std::vector<TH1*>& constituents,
-                                      const bool               norm = true );
+                                      const bool               norm = true,
+                                      const objective          obj  = CHI2 );
 
 
   TemplateFit( const TH1*               target,
                const std::vector<TH1*>& constituents,
-               const bool               normalize_target = true );
+               const bool               normalize_target = true,
+               const objective          obj              = CHI2 );
   ~TemplateFit(){}
 
 
@@ -39,16 +50,44 @@ public:
 
   ROOT::Math::IMultiGenFunction* Clone() const ;
 
+  // Analytic gradients for ROOT::Math::Minimizers
+  void Gradient( const double* x, double* grad ) const;
+  void FdF( const double* x, double& f, double* grad ) const;
+
   // Helping with initializing the minimizer
   void InitMinimizer( ROOT::Math::Minimizer& ) const;
 
+  // Helper functions for pseudo-experiment generation
+  inline const TH1* Target() const { return target; }
+  std::vector<double> Prediction( const double* x ) const;
+  TemplateFit         ReplaceTarget( const TH1* newtarget ) const;
+
 private:
   const TH1* target;
   const std::vector<TH1*> constituents;
   const bool normalize_target;
+  const objective _objective;
+
+  // Snapshot of the histogram contents, see constructor for details.
+  unsigned _nbins;
+  unsigned _ncomp;
+  double _target_integral;
+  std::vector<double> _target_cen;
+  std::vector<double> _target_invup;
+  std::vector<double> _target_invlo;
+  std::vector<double> _template;
+
+  // Additional snapshot for the Barlow-Beeston-lite likelihood
+  std::vector<double> _target_count;
+  std::vector<double> _bb_err2;// bin-major, same as _template
+  std::vector<char> _bb_active;
 
   // Function for interfacing with ROOT::Math::Minimizers
   double DoEval( const double* x ) const;
+  double DoDerivative( const double* x, unsigned icoord ) const;
+
+  double EvalChi2( const double* x, double* grad ) const;
+  double EvalBBLite( const double* x, double* grad ) const;
 
 };
 
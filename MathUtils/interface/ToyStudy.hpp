@@ -0,0 +1,157 @@
+/**
+ * @file    ToyStudy.hpp
+ * @brief   Pseudo-experiment studies for fit bias and coverage
+ * @author  [Yi-Mu "Enoch" Chen](https://github.com/yimuchen)
+ */
+#ifndef USERUTILS_MATHUTILS_TOYSTUDY_HPP
+#define USERUTILS_MATHUTILS_TOYSTUDY_HPP
+
+#ifdef CMSSW_GIT_HASH
+#include "UserUtils/Common/interface/STLUtils/VectorUtils.hpp"
+#include "UserUtils/MathUtils/interface/Measurement/Measurement.hpp"
+#include "UserUtils/MathUtils/interface/RooFitExt.hpp"
+#include "UserUtils/MathUtils/interface/RootMathTools/TemplateFit.hpp"
+#else
+#include "UserUtils/Common/STLUtils/VectorUtils.hpp"
+#include "UserUtils/MathUtils/Measurement/Measurement.hpp"
+#include "UserUtils/MathUtils/RooFitExt.hpp"
+#include "UserUtils/MathUtils/RootMathTools/TemplateFit.hpp"
+#endif
+
+#include <RooAbsPdf.h>
+#include <RooArgSet.h>
+#include <RooCmdArg.h>
+
+#include "TH1D.h"
+
+#include <string>
+#include <vector>
+
+namespace usr
+{
+
+/**
+ * @defgroup ToyStudy ToyStudy
+ * @brief    Pseudo-experiment studies for fit bias and coverage
+ * @ingroup  MathUtils
+ * @details
+ * Running the generate--fit loop of pseudo-experiments (toys), and collecting
+ * the fitted parameter values for the evaluation of the pulls and the coverage
+ * of the fit uncertainties. The number of toys and the random seed is
+ * specified using the usr::NumToys argument. Template fit toys can run on a
+ * pool of worker threads (see usr::NumThreads), while RooFit toys always run
+ * in the calling thread, as RooFit fits are not thread safe. Each toy is
+ * seeded by the seed and the toy index, so the results do not depend on the
+ * number of threads used.
+ * @{
+ */
+
+/**
+ * @brief Container for the fit results of a pseudo-experiment study.
+ */
+class ToyStudyResult
+{
+public:
+  ToyStudyResult( const std::vector<std::string>& names,
+                  const std::vector<double>&      truth,
+                  const unsigned                  ntoys );
+  ~ToyStudyResult(){}
+
+  inline unsigned NParam() const { return _names.size(); }
+  inline unsigned NToys() const { return _status.size(); }
+  unsigned        NConverged() const;
+
+  const std::string& Name( const unsigned i ) const;
+  double             Truth( const unsigned i ) const;
+  double             Value( const unsigned toy, const unsigned i ) const;
+  double             UpperError( const unsigned toy, const unsigned i ) const;
+  double             LowerError( const unsigned toy, const unsigned i ) const;
+  int                Status( const unsigned toy ) const;
+  double             Pull( const unsigned toy, const unsigned i ) const;
+
+  Measurement Coverage( const unsigned i ) const;
+  TH1D*       MakePullHist( const unsigned i,
+                            const unsigned nbins = 40,
+                            const double   min   = -5,
+                            const double   max   = 5 ) const;
+  TH1D* MakeValueHist( const unsigned i, const unsigned nbins = 40 ) const;
+
+  // Functions used for filling in the results
+  void SetStatus( const unsigned toy, const int status );
+  void SetResult( const unsigned toy,
+                  const unsigned i,
+                  const double   value,
+                  const double   errup,
+                  const double   errlo );
+
+private:
+  std::vector<std::string> _names;
+  std::vector<double> _truth;
+  std::vector<double> _value;// toy-major
+  std::vector<double> _errup;
+  std::vector<double> _errlo;
+  std::vector<int> _status;
+};
+
+/**
+ * @{
+ * @brief Pseudo-experiment study of a RooFit PDF.
+ */
+extern ToyStudyResult RunToyStudy( RooAbsPdf&                    pdf,
+                                   const RooArgSet&              observables,
+                                   const std::vector<RooCmdArg>& cmdargs );
+
+inline ToyStudyResult
+RunToyStudy( RooAbsPdf& pdf, const RooArgSet& observables )
+{
+  return RunToyStudy( pdf, observables, {} );
+}
+
+
+template<typename ... Args>
+inline ToyStudyResult
+RunToyStudy( RooAbsPdf&       pdf,
+             const RooArgSet& observables,
+             const RooCmdArg& arg1,
+             Args ... args )
+{
+  return RunToyStudy( pdf, observables,
+                      MakeVector<RooCmdArg>( arg1, args ... ) );
+}
+
+
+/** @} */
+
+/**
+ * @{
+ * @brief Pseudo-experiment study of a histogram template fit.
+ */
+extern ToyStudyResult RunToyStudy( const TemplateFit&            model,
+                                   const std::vector<double>&    truth,
+                                   const std::vector<RooCmdArg>& cmdargs );
+
+inline ToyStudyResult
+RunToyStudy( const TemplateFit& model, const std::vector<double>& truth )
+{
+  return RunToyStudy( model, truth, std::vector<RooCmdArg>() );
+}
+
+
+template<typename ... Args>
+inline ToyStudyResult
+RunToyStudy( const TemplateFit&         model,
+             const std::vector<double>& truth,
+             const RooCmdArg&           arg1,
+             Args ... args )
+{
+  return RunToyStudy( model, truth, MakeVector<RooCmdArg>( arg1, args ... ) );
+}
+
+
+/** @} */
+
+/** @} */
+
+}/* usr */
+
+#endif/* end of include guard: USERUTILS_MATHUTILS_TOYSTUDY_HPP */
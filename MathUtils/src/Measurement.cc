@@ -10,6 +10,7 @@
 #endif
 
 #include <iostream>
+#include <type_traits>
 
 using namespace std;
 
@@ -73,6 +74,16 @@ Measurement::Measurement( const Measurement& x )
 }
 
 
+/**
+ * @brief Conversion from the trivially copyable measurement container.
+ */
+Measurement::Measurement( const MeasurementPOD& x ) :
+  _central_value( x.central ),
+  _error_up     ( x.error_up ),
+  _error_down   ( x.error_down )
+{}
+
+
 /**
  * @brief Nothing to do for the destructor....
  */
@@ -335,4 +346,71 @@ operator/( const double y, const Measurement& x )
   return Measurement( centralValue, err_up, err_dw );
 }
 
+
+/*******************************************************************************
+*   MeasurementPOD - MeasurementPOD arithmetics
+*   Passed to the Measurement routines to ensure identical results.
+*******************************************************************************/
+static_assert( std::is_trivially_copyable<MeasurementPOD>::value,
+               "MeasurementPOD must be trivially copyable" );
+static_assert( std::is_standard_layout<MeasurementPOD>::value,
+               "MeasurementPOD must have standard layout" );
+
+MeasurementPOD
+MeasurementPOD::operator+( const MeasurementPOD& x ) const
+{
+  return MeasurementPOD( Measurement( *this )+Measurement( x ) );
+}
+
+
+MeasurementPOD
+MeasurementPOD::operator-( const MeasurementPOD& x ) const
+{
+  return MeasurementPOD( Measurement( *this )-Measurement( x ) );
+}
+
+
+MeasurementPOD
+MeasurementPOD::operator*( const MeasurementPOD& x ) const
+{
+  return MeasurementPOD( Measurement( *this ) * Measurement( x ) );
+}
+
+
+MeasurementPOD
+MeasurementPOD::operator/( const MeasurementPOD& x ) const
+{
+  return MeasurementPOD( Measurement( *this ) / Measurement( x ) );
+}
+
+
+/*----------------------------------------------------------------------------*/
+
+MeasurementPOD&
+MeasurementPOD::operator+=( const MeasurementPOD& x )
+{
+  return *this = ( *this )+x;
+}
+
+
+MeasurementPOD&
+MeasurementPOD::operator-=( const MeasurementPOD& x )
+{
+  return *this = ( *this )-x;
+}
+
+
+MeasurementPOD&
+MeasurementPOD::operator*=( const MeasurementPOD& x )
+{
+  return *this = ( *this ) * x;
+}
+
+
+MeasurementPOD&
+MeasurementPOD::operator/=( const MeasurementPOD& x )
+{
+  return *this = ( *this ) / x;
+}
+
 }/* usr */
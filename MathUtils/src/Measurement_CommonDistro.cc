@@ -18,11 +18,208 @@
 #include "Math/Functor.h"
 #include "Math/QuantFuncMathCore.h"
 #include "TEfficiency.h"
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <limits>
+#include <unordered_map>
+#include <vector>
 
 namespace usr
 {
 
+/*-----------------------------------------------------------------------------
+ *  Interval cache
+   --------------------------------------------------------------------------*/
+namespace IntervalCache
+{
+
+enum method
+{
+  eff_minos       = 0,
+  eff_bayesian    = 1,
+  eff_clopper     = 2,
+  poisson_minos   = 3,
+  poisson_cmsstat = 4
+};
+
+/**
+ * @brief Identifier of a cached interval: the method used, the non-count
+ * inputs of the method, and the integer counts.
+ *
+ * For Poisson intervals, the second count should be 0.
+ */
+struct Key
+{
+  unsigned method;
+  double   x1;
+  double   x2;
+  double   cl;
+  double   alpha;
+  double   beta;
+};
+
+/**
+ * @brief Cached intervals of a single method and confidence level, keyed by
+ * the pair of integer counts packed into a single 64-bit number (see
+ * IntervalCache::CountKey).
+ *
+ * A hash table is used such that the memory usage grows with the number of
+ * cached intervals, and not with the values of the counts.
+ */
+struct Series
+{
+  unsigned                                  method;
+  double                                    cl;
+  double                                    alpha;
+  double                                    beta;
+  std::unordered_map<uint64_t, Measurement> values;
+};
+
+/**
+ * @brief Per-thread cache table, so that no locking is required.
+ *
+ * The table is dropped when it is older than the last call to
+ * IntervalCache::Clear, or when it is full.
+ */
+struct Table
+{
+  std::vector<Series> series;
+  size_t              entries    = 0;
+  unsigned            generation = 0;
+};
+
+static std::atomic<unsigned> generation( 0 );
+static std::atomic<size_t>   maxentries( 1 << 16 );
+static thread_local Table    table;
+
+/**
+ * @brief Whether the input can be used as a cache index.
+ */
+static bool
+IsCount( const double x )
+{
+  return x >= 0 && x < std::numeric_limits<unsigned>::max()
+         && std::floor( x ) == x;
+}
+
+
+/**
+ * @brief Packing the two counts into the hash table key of a Series, the counts
+ * are assumed to have passed the IsCount check.
+ */
+static uint64_t
+CountKey( const double x1, const double x2 )
+{
+  return ( uint64_t( x2 ) << 32 ) | uint64_t( x1 );
+}
+
+
+/**
+ * @brief Looking up the interval in the cache of the calling thread,
+ * computing and storing it if it is not present.
+ *
+ * Only intervals with exact integer counts (with passed not exceeding total
+ * for efficiencies) are cached, all other inputs are computed directly. Once
+ * the table holds the number of entries set by IntervalCache::SetMaxEntries,
+ * it is dropped and filled again.
+ */
+template<typename FUNC>
+static Measurement
+Lookup( const Key& key, FUNC&& compute )
+{
+  const size_t limit = maxentries.load( std::memory_order_relaxed );
+  if( limit == 0 || !IsCount( key.x1 ) || !IsCount( key.x2 ) ){
+    return compute();
+  }
+  const bool poisson = key.method == poisson_minos
+                       || key.method == poisson_cmsstat;
+  if( !poisson && key.x1 > key.x2 ){
+    return compute();
+  }
+
+  const unsigned gen = generation.load( std::memory_order_acquire );
+  if( table.generation != gen || table.entries >= limit ){
+    table.series.clear();
+    table.entries    = 0;
+    table.generation = gen;
+  }
+
+  Series* series = nullptr;
+
+  for( auto& s : table.series ){
+    if( s.method == key.method && s.cl == key.cl && s.alpha == key.alpha
+        && s.beta == key.beta ){
+      series = &s;
+      break;
+    }
+  }
+
+  if( !series ){
+    table.series.push_back( { key.method, key.cl, key.alpha, key.beta, {} } );
+    series = &table.series.back();
+  }
+
+  const uint64_t countkey = CountKey( key.x1, key.x2 );
+  const auto     it       = series->values.find( countkey );
+  if( it != series->values.end() ){
+    return it->second;
+  }
+
+  const Measurement ans = compute();
+  series->values.emplace( countkey, ans );
+  ++table.entries;
+
+  return ans;
+}
+
+
+/**
+ * @brief Removing all cached intervals.
+ * @ingroup StatUtils
+ *
+ * The Minos intervals depend on the default minimizer settings (see
+ * usr::MakeMinos), so the cache should be cleared if the settings are changed
+ * after intervals have been computed. The tables of all threads are
+ * invalidated, and are dropped the next time they are used.
+ */
+void
+Clear()
+{
+  generation.fetch_add( 1, std::memory_order_acq_rel );
+}
+
+
+/**
+ * @brief Setting the maximum number of cached intervals per thread (0
+ * disables caching).
+ * @ingroup StatUtils
+ *
+ * A table holding this many entries is dropped and filled again.
+ */
+void
+SetMaxEntries( const size_t x )
+{
+  maxentries.store( x, std::memory_order_relaxed );
+}
+
+
+/**
+ * @brief Number of cached intervals of the calling thread.
+ * @ingroup StatUtils
+ */
+size_t
+Size()
+{
+  return table.generation == generation.load( std::memory_order_acquire ) ?
+         table.entries :
+         0;
+}
+
+}/* IntervalCache */
+
+/*----------------------------------------------------------------------------*/
+
 namespace Efficiency
 {
 
@@ -37,10 +234,14 @@ namespace Efficiency
 Measurement
 Minos( const double passed, const double total, const double confidencelevel )
 {
-  return MakeMinos( usr::stat::BinomialNLL( passed, total ),
-                    usr::eff_machine_epsilon,
-                    1-usr::eff_machine_epsilon,
-                    confidencelevel  );
+  return IntervalCache::Lookup(
+    { IntervalCache::eff_minos, passed, total, confidencelevel, 0, 0 },
+    [&](){
+    return MakeMinos( usr::stat::BinomialNLL( passed, total ),
+                      usr::eff_machine_epsilon,
+                      1-usr::eff_machine_epsilon,
+                      confidencelevel  );
+  } );
 }
 
 
@@ -62,24 +263,29 @@ Bayesian( double passed,
           double alpha,
           double beta )
 {
-  const double central = ( passed+alpha-1. ) / ( total+alpha+beta-2. );
-  const double err_up  = TEfficiency::Bayesian(
-    total,
-    passed,
-    confidencelevel,
-    alpha,
-    beta,
-    true,// For upper boundary
-    confidencemethod )-central;
-  const double err_down = central-TEfficiency::Bayesian(
-    total,
-    passed,
-    confidencelevel,
-    alpha,
-    beta,
-    false,// For lower boundary
-    confidencemethod );
-  return Measurement( central, err_up, err_down );
+  return IntervalCache::Lookup(
+    { IntervalCache::eff_bayesian+( confidencemethod ? 0x100u : 0u ),
+      passed, total, confidencelevel, alpha, beta },
+    [&](){
+    const double central = ( passed+alpha-1. ) / ( total+alpha+beta-2. );
+    const double err_up  = TEfficiency::Bayesian(
+      total,
+      passed,
+      confidencelevel,
+      alpha,
+      beta,
+      true,// For upper boundary
+      confidencemethod )-central;
+    const double err_down = central-TEfficiency::Bayesian(
+      total,
+      passed,
+      confidencelevel,
+      alpha,
+      beta,
+      false,// For lower boundary
+      confidencemethod );
+    return Measurement( central, err_up, err_down );
+  } );
 }
 
 
@@ -93,16 +299,20 @@ ClopperPearson( const double passed,
                 const double total,
                 const double confidencelevel )
 {
-  const double central = passed / total;
-  const double err_up  = TEfficiency::ClopperPearson( total,
-                                                      passed,
-                                                      confidencelevel,
-                                                      true )-central;
-  const double err_down = central-TEfficiency::ClopperPearson( total,
-                                                               passed,
-                                                               confidencelevel,
-                                                               false );
-  return Measurement( central, err_up, err_down );
+  return IntervalCache::Lookup(
+    { IntervalCache::eff_clopper, passed, total, confidencelevel, 0, 0 },
+    [&](){
+    const double central = passed / total;
+    const double err_up  = TEfficiency::ClopperPearson( total,
+                                                        passed,
+                                                        confidencelevel,
+                                                        true )-central;
+    const double err_down = central-TEfficiency::ClopperPearson( total,
+                                                                 passed,
+                                                                 confidencelevel,
+                                                                 false );
+    return Measurement( central, err_up, err_down );
+  } );
 }
 
 
@@ -144,10 +354,14 @@ Minos( const double obs, const double confidencelevel )
     return Measurement( 0, 0, 0 );
   }
 
-  return MakeMinos( usr::stat::PoissonNLL( obs ),
-                    usr::eff_machine_epsilon,
-                    obs+obs * obs+1,
-                    confidencelevel );
+  return IntervalCache::Lookup(
+    { IntervalCache::poisson_minos, obs, 0, confidencelevel, 0, 0 },
+    [&](){
+    return MakeMinos( usr::stat::PoissonNLL( obs ),
+                      usr::eff_machine_epsilon,
+                      obs+obs * obs+1,
+                      confidencelevel );
+  } );
 }
 
 
@@ -177,13 +391,17 @@ Lazy( const double obs, const double confidencelevel )
 Measurement
 CMSStatCom( const double obs, const double confidencelevel )
 {
-  const double alpha = 1-confidencelevel;
-  const double lower = ( obs == 0.0 ) ?
-                       0.0 :
-                       ( ROOT::Math::gamma_quantile( alpha / 2, obs, 1. ) );
-  const double upper = ROOT::Math::gamma_quantile_c( alpha / 2, obs+1, 1 );
+  return IntervalCache::Lookup(
+    { IntervalCache::poisson_cmsstat, obs, 0, confidencelevel, 0, 0 },
+    [&](){
+    const double alpha = 1-confidencelevel;
+    const double lower = ( obs == 0.0 ) ?
+                         0.0 :
+                         ( ROOT::Math::gamma_quantile( alpha / 2, obs, 1. ) );
+    const double upper = ROOT::Math::gamma_quantile_c( alpha / 2, obs+1, 1 );
 
-  return Measurement( obs, upper-obs,  obs-lower );
+    return Measurement( obs, upper-obs,  obs-lower );
+  } );
 }
 
 }/* Poisson */
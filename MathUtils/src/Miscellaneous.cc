@@ -5,21 +5,31 @@
  */
 
 #ifdef CMSSW_GIT_HASH
-#include "UserUtils/Common/interface/SystemUtils/Time.hpp"
 #include "UserUtils/MathUtils/interface/Miscellaneous.hpp"
+#include "UserUtils/MathUtils/interface/RandomUtils.hpp"
 #else
-#include "UserUtils/Common/SystemUtils/Time.hpp"
 #include "UserUtils/MathUtils/Miscellaneous.hpp"
+#include "UserUtils/MathUtils/RandomUtils.hpp"
 #endif
 
 #include "TMath.h"
-#include "TRandom3.h"
+#include "TMatrixDSymEigen.h"
 #include "TVectorD.h"
+
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <vector>
 
 namespace usr
 {
 
+static bool     DecompCholBlocked( double*, const double*, const unsigned );
+static TMatrixD CorrelateGaussian( const TVectorD&,
+                                   const TMatrixDSym&,
+                                   const unsigned,
+                                   const std::vector<double>& );
+
 /**
  * @brief returning the intersect points of two segments if exists.
  *
@@ -62,65 +72,211 @@ Intersect( const double p1x,
 /**
  * @brief Performing a Cholesky decomposing of a covariance matrix from fit
  *
- * In the case that the input matrix is not positive definite, this function
- * will
- * a diagonal matrix that is just the square root of the diagonal components of
- * the original covariance matrix. The function is essentially the
+ * The return matrix \f$U\f$ is upper triangular such that \f$M = U^T U\f$,
+ * the same convention as the
  * [TDecompChol::Decompose](https://root.cern.ch/doc/master/classTDecompChol.html#af14df10a3c766330cb93063161ecedc0)
- * method without exceptions.
+ * method but without exceptions. The decomposition is performed in blocks of
+ * columns (see DecompCholBlocked), such that the update of the trailing
+ * sub-matrix runs over contiguous memory.
+ *
+ * In the case that the input matrix is not positive definite (or is too close
+ * to singular for the decomposition to be numerically stable), the
+ * decomposition falls back to the eigen-decomposition \f$M = V D V^T\f$ of
+ * the symmetric matrix, with negative eigenvalues (from rounding errors)
+ * clipped to zero. The return matrix is then \f$U = \sqrt{D} V^T\f$, which is
+ * no longer triangular, but still satisfies \f$M = U^T U\f$, which is all that
+ * is required for generating correlated variations.
  */
 extern TMatrixD
 DecompCorvariance( const TMatrixDSym& m )
 {
-  const unsigned n       = m.GetNrows();
-  TMatrixD       ans     = m;
-  double*        ans_ptr = ans.GetMatrixArray();
+  const unsigned n   = m.GetNrows();
+  TMatrixD       ans = m;
+
+  if( DecompCholBlocked( ans.GetMatrixArray(), m.GetMatrixArray(), n ) ){
+    return ans;
+  }
 
-  for( unsigned icol = 0; icol < n; icol++ ){
-    const unsigned rowOff = icol * n;
+  const TMatrixDSymEigen eigen( m );
+  const TVectorD&        val = eigen.GetEigenValues();
+  const TMatrixD&        vec = eigen.GetEigenVectors();
 
-    double ujj = ans_ptr[rowOff+icol];
+  for( unsigned i = 0; i < n; ++i ){
+    const double sqrtval = TMath::Sqrt( std::max( val[i], 0.0 ) );
 
-    for( unsigned irow = 0; irow < icol; irow++ ){
-      const unsigned pos_ij = irow * n+icol;
-      ujj -= ans_ptr[pos_ij] * ans_ptr[pos_ij];
+    for( unsigned j = 0; j < n; ++j ){
+      ans[i][j] = sqrtval * vec[j][i];
     }
+  }
 
-    if( ujj <= 0 ){// Special returning case for any non-definite positive case
-      for( unsigned i = 0; i < n; ++i ){
-        const unsigned offset = i * n;
+  return ans;
+}
 
-        for( unsigned j = 0; j < n; ++j ){
-          ans_ptr[i+offset] = i != j ?
-                              0 :
-                              TMath::Sqrt( m[i][j] );
-        }
+
+/**
+ * @brief Blocked in-place Cholesky decomposition of a row-major symmetric
+ * matrix into the upper triangular form \f$M = U^T U\f$.
+ *
+ * For each block of columns, the diagonal block is decomposed with the
+ * standard element-by-element algorithm, then the panel to the right of the
+ * diagonal block is solved, and finally the trailing sub-matrix is updated
+ * with the panel outer product row-by-row. Returns false if a pivot is not
+ * sufficiently positive compared to the original diagonal element, in which
+ * case the contents of the array is undefined. The lower triangular part is
+ * set to zero on success.
+ */
+static bool
+DecompCholBlocked( double* a, const double* orig, const unsigned n )
+{
+  static const unsigned blocksize = 16;
+  static const double   tolerance = 1e3 * std::numeric_limits<double>::epsilon();
+
+  for( unsigned kb = 0; kb < n; kb += blocksize ){
+    const unsigned ke = std::min( kb+blocksize, n );
+
+    // Decomposing the diagonal block
+    for( unsigned j = kb; j < ke; ++j ){
+      double ujj = a[j * n+j];
+
+      for( unsigned i = kb; i < j; ++i ){
+        ujj -= a[i * n+j] * a[i * n+j];
       }
 
-      return ans;
+      if( ujj <= tolerance * orig[j * n+j] || ujj <= 0 ){
+        return false;
+      }
+
+      ujj        = std::sqrt( ujj );
+      a[j * n+j] = ujj;
+
+      for( unsigned k = j+1; k < ke; ++k ){
+        double ujk = a[j * n+k];
+
+        for( unsigned i = kb; i < j; ++i ){
+          ujk -= a[i * n+j] * a[i * n+k];
+        }
+
+        a[j * n+k] = ujk / ujj;
+      }
     }
-    ujj                  = TMath::Sqrt( ujj );
-    ans_ptr[rowOff+icol] = ujj;
-
-    if( icol < n-1 ){
-      for( unsigned j = icol+1; j < n; j++ ){
-        for( unsigned i = 0; i < icol; i++ ){
-          const unsigned rowOff2 = i * n;
-          ans_ptr[rowOff+j] -= ans_ptr[rowOff2+j] * ans_ptr[rowOff2+icol];
+
+    // Solving the panel to the right of the diagonal block
+    for( unsigned j = kb; j < ke; ++j ){
+      const double ujj = a[j * n+j];
+      double*      row = a+j * n;
+
+      for( unsigned i = kb; i < j; ++i ){
+        const double  uij  = a[i * n+j];
+        const double* irow = a+i * n;
+
+        for( unsigned k = ke; k < n; ++k ){
+          row[k] -= uij * irow[k];
         }
       }
 
-      for( unsigned j = icol+1; j < n; j++ ){
-        ans_ptr[rowOff+j] /= ujj;
+      for( unsigned k = ke; k < n; ++k ){
+        row[k] /= ujj;
+      }
+    }
+
+    // Updating the trailing sub-matrix (upper triangle only)
+    for( unsigned p = kb; p < ke; ++p ){
+      const double* prow = a+p * n;
+
+      for( unsigned i = ke; i < n; ++i ){
+        const double upi = prow[i];
+        double*      row = a+i * n;
+        if( upi == 0 ){ continue; }
+
+        for( unsigned j = i; j < n; ++j ){
+          row[j] -= upi * prow[j];
+        }
       }
     }
   }
 
   for( unsigned irow = 0; irow < n; irow++ ){
-    const unsigned rowOff = irow * n;
-
     for( unsigned icol = 0; icol < irow; icol++ ){
-      ans_ptr[rowOff+icol] = 0.;
+      a[irow * n+icol] = 0.;
+    }
+  }
+
+  return true;
+}
+
+
+/**
+ * @brief Generating a batch of correlated Gaussian random vectors.
+ *
+ * The return matrix has `nsamples` rows, with each row being an independent
+ * sample of the multivariate Gaussian distribution with the given mean and
+ * covariance matrix. The covariance matrix is decomposed only once using the
+ * DecompCorvariance function, and each sample is generated as
+ * \f$x = \mu + z U\f$ for a row vector \f$z\f$ of standard normal random
+ * numbers. The sample matrix is accumulated row-by-row over contiguous memory.
+ */
+extern TMatrixD
+SampleCorrelatedGaussian( const TVectorD&    mean,
+                          const TMatrixDSym& cov,
+                          const unsigned     nsamples,
+                          TRandom&           rand )
+{
+  std::vector<double> z( nsamples * cov.GetNrows() );
+
+  for( auto& x : z ){
+    x = rand.Gaus( 0, 1 );
+  }
+
+  return CorrelateGaussian( mean, cov, nsamples, z );
+}
+
+
+/**
+ * @brief Generating a batch of correlated Gaussian random vectors using the
+ * thread-local random number stream (see usr::rng::ThreadStream), with all
+ * standard normal numbers generated in a single call.
+ */
+extern TMatrixD
+SampleCorrelatedGaussian( const TVectorD&    mean,
+                          const TMatrixDSym& cov,
+                          const unsigned     nsamples )
+{
+  const std::vector<double> z = usr::rng::Gaus( nsamples * cov.GetNrows() );
+  return CorrelateGaussian( mean, cov, nsamples, z );
+}
+
+
+/**
+ * @brief Transforming a batch of standard normal vectors (stored
+ * sample-major) into correlated Gaussian vectors.
+ */
+static TMatrixD
+CorrelateGaussian( const TVectorD&            mean,
+                   const TMatrixDSym&         cov,
+                   const unsigned             nsamples,
+                   const std::vector<double>& z )
+{
+  const unsigned n       = cov.GetNrows();
+  const TMatrixD u       = DecompCorvariance( cov );
+  const double*  u_ptr   = u.GetMatrixArray();
+  TMatrixD       ans( nsamples, n );
+  double*        ans_ptr = ans.GetMatrixArray();
+
+  for( unsigned s = 0; s < nsamples; ++s ){
+    double*       row  = ans_ptr+s * n;
+    const double* zrow = z.data()+s * n;
+
+    for( unsigned i = 0; i < n; ++i ){
+      row[i] = mean[i];
+    }
+
+    for( unsigned i = 0; i < n; ++i ){
+      const double  zi   = zrow[i];
+      const double* urow = u_ptr+i * n;
+
+      for( unsigned j = 0; j < n; ++j ){
+        row[j] += zi * urow[j];
+      }
     }
   }
 
@@ -188,21 +344,15 @@ GetEffectiveEvents( const TH1*hist, const int bin )
  * @brief Generating a random point on an n-sphere.
  *
  * Here we are first generating n independent random Gaussian variables, the
- * normalizing onto the unit sphere.
+ * normalizing onto the unit sphere. The random numbers are taken from the
+ * thread-local random number stream (see usr::rng::ThreadStream), so the
+ * results are reproducible given the global seed.
  */
 extern TVectorD
 RandomOnSphere( const unsigned n )
 {
   TVectorD ans( n );
-  TRandom3 rand;
-  rand.SetSeed( usr::CurrentTimeInNanSec() );
-
-  for( unsigned i = 0 ; i < n ; ++i ){
-    ans[i] = rand.Gaus( 0, 1 );
-  }
-
-  ans *= 1 / TMath::Sqrt( ans.Norm2Sqr() );
-
+  usr::rng::ThreadStream().FillOnSphere( ans.GetMatrixArray(), n );
   return ans;
 }
 
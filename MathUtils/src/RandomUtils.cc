@@ -0,0 +1,272 @@
+/**
+ * @file    RandomUtils.cc
+ * @brief   Implementation of the reproducible random number streams
+ * @author  [Yi-Mu "Enoch" Chen](https://github.com/yimuchen)
+ */
+#ifdef CMSSW_GIT_HASH
+#include "UserUtils/MathUtils/interface/RandomUtils.hpp"
+#else
+#include "UserUtils/MathUtils/RandomUtils.hpp"
+#endif
+
+#include <atomic>
+#include <cmath>
+
+namespace usr
+{
+
+namespace rng
+{
+
+static const uint64_t golden = 0x9e3779b97f4a7c15ULL;
+
+/**
+ * @brief SplitMix64 finalizer, a bijective 64-bit mixing function.
+ */
+static inline uint64_t
+Mix( uint64_t z )
+{
+  z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+  z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+  return z ^ ( z >> 31 );
+}
+
+
+// Global seed, and the epoch counter used to signal the thread-local streams
+// that the global seed has changed.
+static std::atomic<uint64_t> global_seed( 0x5eed5eed5eed5eedULL );
+static std::atomic<uint64_t> global_epoch( 0 );
+static std::atomic<uint64_t> thread_count( 0 );
+
+/**
+ * @brief Creating a stream from the global seed and a stream identifier.
+ */
+Stream::Stream( const uint64_t id )
+{
+  Reset( GlobalSeed(), id );
+}
+
+
+/**
+ * @brief Creating a stream from an explicit seed and a stream identifier,
+ * independent of the global seed.
+ */
+Stream::Stream( const uint64_t seed, const uint64_t id )
+{
+  Reset( seed, id );
+}
+
+
+/**
+ * @brief Resetting the stream to the start of the sequence given by the seed
+ * and stream identifier.
+ */
+void
+Stream::Reset( const uint64_t seed, const uint64_t id )
+{
+  _key     = Mix( Mix( seed )+golden * ( 2 * id+1 ) );
+  _counter = 0;
+}
+
+
+/**
+ * @brief Raw 64-bit output of the stream.
+ */
+uint64_t
+Stream::Next()
+{
+  return Mix( _key+golden * ( ++_counter ) );
+}
+
+
+/**
+ * @brief Uniform random number in [0,1), using the top 53 bits of the output.
+ */
+double
+Stream::Uniform()
+{
+  return ( Next() >> 11 ) * ( 1.0 / 9007199254740992.0 );
+}
+
+
+/**
+ * @brief Standard normal random number using the Box--Muller transform.
+ *
+ * Only one of the two normal numbers of the transformation is used, so that
+ * the stream has no hidden state other than the counter.
+ */
+double
+Stream::Gaus()
+{
+  const double u1 = 1.0-Uniform();// (0,1]
+  const double u2 = Uniform();
+  return std::sqrt( -2 * std::log( u1 ) ) * std::cos( 2 * M_PI * u2 );
+}
+
+
+/**
+ * @brief Filling an array with uniform random numbers in [min, max).
+ */
+void
+Stream::FillUniform( double*      x,
+                     const size_t n,
+                     const double min,
+                     const double max )
+{
+  const double width = max-min;
+
+  for( size_t i = 0; i < n; ++i ){
+    x[i] = min+width * Uniform();
+  }
+}
+
+
+/**
+ * @brief Filling an array with Gaussian random numbers.
+ *
+ * Both numbers of the Box--Muller transformation are used for the bulk
+ * generation.
+ */
+void
+Stream::FillGaus( double*      x,
+                  const size_t n,
+                  const double mean,
+                  const double sigma )
+{
+  size_t i = 0;
+
+  for( ; i+1 < n; i += 2 ){
+    const double u1 = 1.0-Uniform();
+    const double u2 = Uniform();
+    const double r  = sigma * std::sqrt( -2 * std::log( u1 ) );
+    x[i]   = mean+r * std::cos( 2 * M_PI * u2 );
+    x[i+1] = mean+r * std::sin( 2 * M_PI * u2 );
+  }
+
+  if( i < n ){
+    x[i] = mean+sigma * Gaus();
+  }
+}
+
+
+/**
+ * @brief Filling an array with `n` random points uniformly distributed on the
+ * unit (dim-1)-sphere, stored contiguously (point-major).
+ *
+ * The points are generated by normalizing vectors of independent Gaussian
+ * random numbers.
+ */
+void
+Stream::FillOnSphere( double* x, const size_t dim, const size_t n )
+{
+  FillGaus( x, dim * n );
+
+  for( size_t p = 0; p < n; ++p ){
+    double* point = x+p * dim;
+    double  norm  = 0;
+
+    for( size_t i = 0; i < dim; ++i ){
+      norm += point[i] * point[i];
+    }
+
+    norm = 1 / std::sqrt( norm );
+
+    for( size_t i = 0; i < dim; ++i ){
+      point[i] *= norm;
+    }
+  }
+}
+
+
+/*-----------------------------------------------------------------------------
+ *  Global seed and thread-local streams
+   --------------------------------------------------------------------------*/
+
+/**
+ * @brief Setting the global seed of all random number streams.
+ *
+ * The thread-local streams are reset on their next use, so the change
+ * applies to all threads. For reproducible results in multi-threaded
+ * routines where the assignment of jobs to threads is not deterministic,
+ * an explicit stream should be constructed for each job (usually using the
+ * job index as the stream identifier) instead of using the thread-local
+ * streams.
+ */
+void
+SetGlobalSeed( const uint64_t seed )
+{
+  global_seed = seed;
+  ++global_epoch;
+}
+
+
+uint64_t
+GlobalSeed()
+{
+  return global_seed;
+}
+
+
+/**
+ * @brief Random number stream owned by the calling thread.
+ *
+ * Each thread is assigned a distinct stream identifier on its first call, in
+ * the order threads first request a stream. The main thread (if it is the
+ * first to request a stream) hence always obtains the same sequence for a
+ * given global seed.
+ */
+Stream&
+ThreadStream()
+{
+  static thread_local const uint64_t id = thread_count++;
+  static thread_local uint64_t       epoch = global_epoch;
+  static thread_local Stream         stream( id );
+
+  if( epoch != global_epoch ){
+    epoch = global_epoch;
+    stream.Reset( GlobalSeed(), id );
+  }
+
+  return stream;
+}
+
+
+/**
+ * @brief Vector of uniform random numbers from the thread-local stream.
+ */
+std::vector<double>
+Uniform( const size_t n, const double min, const double max )
+{
+  std::vector<double> ans( n );
+  ThreadStream().FillUniform( ans.data(), n, min, max );
+  return ans;
+}
+
+
+/**
+ * @brief Vector of Gaussian random numbers from the thread-local stream.
+ */
+std::vector<double>
+Gaus( const size_t n, const double mean, const double sigma )
+{
+  std::vector<double> ans( n );
+  ThreadStream().FillGaus( ans.data(), n, mean, sigma );
+  return ans;
+}
+
+
+/**
+ * @brief Vector of random points on the unit sphere from the thread-local
+ * stream, see Stream::FillOnSphere for the layout.
+ */
+std::vector<double>
+OnSphere( const size_t dim, const size_t n )
+{
+  std::vector<double> ans( dim * n );
+  ThreadStream().FillOnSphere( ans.data(), dim, n );
+  return ans;
+}
+
+}/* rng */
+
+}/* usr */
@@ -1,15 +1,24 @@
 #ifdef CMSSW_GIT_HASH
 #include "UserUtils/Common/interface/RootUtils/RooArgContainer.hpp"
+#include "UserUtils/Common/interface/STLUtils/OStreamUtils.hpp"
 #include "UserUtils/Common/interface/STLUtils/StringUtils.hpp"
 #include "UserUtils/MathUtils/interface/RooFitExt.hpp"
 #else
 #include "UserUtils/Common/RootUtils/RooArgContainer.hpp"
+#include "UserUtils/Common/STLUtils/OStreamUtils.hpp"
 #include "UserUtils/Common/STLUtils/StringUtils.hpp"
 #include "UserUtils/MathUtils/RooFitExt.hpp"
 #endif
 
 #include <RooAbsPdf.h>
 #include <RooFitResult.h>
+#include <RooRealVar.h>
+#include <TRandom3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
 
 namespace usr
 {
@@ -41,12 +50,82 @@ USERUTILS_COMMON_REGISTERCMD( MaxFitIteration );
 RooCmdArg MaxFitIteration( unsigned x )
 { return RooCmdArg( "MaxFitIteration", x ); }
 
+USERUTILS_COMMON_REGISTERCMD( MultiStart );
+
+/**
+ * @brief Requesting the ConvergeFitPDFToData function to run in multi-start
+ * mode with `npoints` initial parameter sets.
+ *
+ * The mode should be one of the usr::multistart enums, and the seed is used
+ * for generating the perturbed initial parameters.
+ */
+RooCmdArg MultiStart( const unsigned npoints,
+                      const int      mode,
+                      const unsigned seed )
+{ return RooCmdArg( "MultiStart", npoints, mode, seed ); }
+
+USERUTILS_COMMON_REGISTERCMD( NumThreads );
+
+/**
+ * @brief Maximum number of threads to use for parallel routines (0 to use all
+ * available hardware threads).
+ */
+RooCmdArg NumThreads( const unsigned n )
+{ return RooCmdArg( "NumThreads", n ); }
+
+static RooFitResult* MultiStartFitPDFToData( RooAbsPdf&,
+                                             RooAbsData&,
+                                             const RooArgContainer& );
+
+/**
+ * @brief Number of grid cells in each of the `ndim` dimensions, such that the
+ * total number of cells does not exceed `nmax`.
+ *
+ * All dimensions get the same number of cells `n = floor( nmax^(1/ndim) )`,
+ * and the leading dimensions are then given one extra cell each for as long
+ * as the total number of cells stays within `nmax`. The last entry is always
+ * the smallest, and is smaller than 2 if `nmax < 2^ndim`.
+ */
+static std::vector<unsigned>
+GridSize( const unsigned ndim, const unsigned nmax )
+{
+  auto Product = []( const std::vector<unsigned>& x ){
+                   double ans = 1;
+
+                   for( const auto n : x ){ ans *= n; }
+
+                   return ans;
+                 };
+
+  unsigned n = std::floor( std::pow( nmax, 1.0 / ndim ) );
+
+  // Correcting for floating point rounding of the root.
+  while( std::pow( n+1, ndim ) <= nmax ){ ++n; }
+  while( n > 1 && std::pow( n, ndim ) > nmax ){ --n; }
+
+  std::vector<unsigned> ans( ndim, std::max( n, 1u ) );
+
+  for( unsigned i = 0; i < ndim; ++i ){
+    if( Product( ans ) / ans[i] * ( ans[i]+1 ) > nmax ){ break; }
+    ++ans[i];
+  }
+
+  return ans;
+}
+
+
 /**
  * @details
  * Running the PDF fit routine multiple times until the resulting RooFitResults
  * returns a nominal exit code (status() == 0). You can use the New RooCmdArg
  * `usr::MaxFitIteration` fo specify the maximum number of fit interation to
- * perform (defaults to 10).
+ * perform (defaults to 10). Each iteration starts from the end point of the
+ * previous iteration.
+ *
+ * If the `usr::MultiStart` argument is specified, the fit will instead be
+ * performed independently from multiple initial parameter sets, with the
+ * best converged result being kept. See the helper function
+ * MultiStartFitPDFToData for more details.
  */
 extern RooFitResult*
 ConvergeFitPDFToData( RooAbsPdf&                    pdf,
@@ -59,21 +138,20 @@ ConvergeFitPDFToData( RooAbsPdf&                    pdf,
     } );
   const usr::RooArgContainer og_args( cmdargs );
 
-  RooLinkedList roolist = args.MakeRooList();
-
-  for( int i = 0; i < args.Get( "MaxFitIteration" ).getInt( 0 ); ++i ){
-    status = FitPDFToData( pdf, data, args );
-    if( status->status() != 0 ){
-      if( !og_args.Has( "Save" ) ){
-        return nullptr;
-      } else {
-        return status;
+  if( args.Has( "MultiStart" ) ){
+    status = MultiStartFitPDFToData( pdf, data, args );
+  } else {
+    for( int i = 0; i < args.Get( "MaxFitIteration" ).getInt( 0 ); ++i ){
+      if( status ){ delete status; }
+      status = FitPDFToData( pdf, data, args );
+      if( status->status() == 0 ){
+        break;
       }
     }
-    delete status;
   }
 
   if( !og_args.Has( "Save" ) ){
+    if( status ){ delete status; }
     return nullptr;
   } else {
     return status;
@@ -81,6 +159,191 @@ ConvergeFitPDFToData( RooAbsPdf&                    pdf,
 }
 
 
+/**
+ * @brief Running the multi-start fit routine.
+ *
+ * The initial parameter sets are generated for the floating parameters of the
+ * PDF before any of the fits are performed:
+ *
+ * - The first set is always the present parameter values.
+ * - In `usr::multistart_perturb` mode, the remaining sets are Gaussian
+ *   perturbations around the present values, with the width being the present
+ *   parameter uncertainty (or 10% of the parameter range if the uncertainty is
+ *   not set), clamped to the parameter range. The random sequence is fixed by
+ *   the seed given in the usr::MultiStart argument.
+ * - In `usr::multistart_grid` mode, the remaining sets are taken from the
+ *   centers of the cells of a regular grid spanning the ranges of the bounded
+ *   parameters (see GridSize for the number of cells in each dimension). Sets
+ *   that do not fit into the grid, as well as unbounded parameters, use the
+ *   Gaussian perturbations. If there are not enough sets for 2 cells in every
+ *   dimension, a warning is printed and the sets are instead sampled from a
+ *   Latin hypercube, so that every parameter is still varied.
+ *
+ * The fits are then performed one after another in the calling thread. RooFit
+ * keeps process-wide states (message service, name registry, integral caches
+ * and the minimizer instance) that are not protected against concurrent fits,
+ * even on cloned PDFs, so the fits are not distributed over threads.
+ *
+ * The result with smallest NLL value among the converged fits (status() == 0)
+ * is selected, with ties broken by the index of the initial parameter set. If none of the fits
+ * converged, the result with the smallest NLL value is used instead. The
+ * parameters of the original PDF are set to the selected fit results.
+ */
+static RooFitResult*
+MultiStartFitPDFToData( RooAbsPdf&             pdf,
+                        RooAbsData&            data,
+                        const RooArgContainer& args )
+{
+  const unsigned npoints = std::max( args.GetInt( "MultiStart", 0 ), 1 );
+  const int      mode    = args.GetInt( "MultiStart", 1 );
+  const unsigned seed    = args.GetDouble( "MultiStart", 0 );
+
+  // Getting the list of floating parameters.
+  std::unique_ptr<RooArgSet> params( pdf.getParameters( data ) );
+  std::vector<RooRealVar*>   floating;
+
+  for( const auto arg : *params ){
+    RooRealVar* var = dynamic_cast<RooRealVar*>( arg );
+    if( var && !var->isConstant() ){
+      floating.push_back( var );
+    }
+  }
+
+  const unsigned ndim = floating.size();
+
+  // Setting up the grid over the bounded parameters.
+  std::vector<unsigned> bounded;
+
+  for( unsigned i = 0; i < ndim; ++i ){
+    if( floating[i]->hasMin() && floating[i]->hasMax() ){
+      bounded.push_back( i );
+    }
+  }
+
+  TRandom3 rand( seed+1 );// TRandom3 seed of 0 is machine random
+  const bool usegrid = mode == multistart_grid && npoints > 1
+                       && !bounded.empty();
+  std::vector<unsigned> gridsize;
+  std::vector<unsigned> gridcell( ndim, 0 );
+  std::vector<std::vector<unsigned> > latin;
+  unsigned ngridpoints = 0;
+
+  if( usegrid ){
+    gridsize = GridSize( bounded.size(), npoints-1 );
+
+    if( gridsize.back() >= 2 ){
+      ngridpoints = std::accumulate( gridsize.begin(), gridsize.end(), 1u,
+                                     std::multiplies<unsigned>() );
+    } else {
+      usr::log::PrintLog( usr::log::WARNING,
+        usr::fstr( "%u grid points cannot span %u bounded parameters with at "
+                   "least 2 points each, using a Latin hypercube instead",
+                   npoints-1, bounded.size() ),
+        "MultiStartFitPDFToData" );
+
+      // Each bounded parameter takes a random permutation of the npoints-1
+      // strata of its range.
+      latin.resize( ndim );
+
+      for( const auto i : bounded ){
+        latin[i].resize( npoints-1 );
+        std::iota( latin[i].begin(), latin[i].end(), 0u );
+
+        for( unsigned k = npoints-2; k > 0; --k ){
+          std::swap( latin[i][k], latin[i][rand.Integer( k+1 )] );
+        }
+      }
+    }
+  }
+
+  // Generating the initial parameter sets (flat, point-major).
+  std::vector<double> start( npoints * ndim );
+
+  for( unsigned p = 0; p < npoints; ++p ){
+    unsigned gridindex = p-1;
+
+    for( unsigned j = 0; j < bounded.size() && p > 0 && p <= ngridpoints; ++j ){
+      gridcell[bounded[j]] = gridindex % gridsize[j];
+      gridindex           /= gridsize[j];
+    }
+
+    for( unsigned i = 0; i < ndim; ++i ){
+      const RooRealVar* var = floating.at( i );
+      const double      min = var->getMin();
+      const double      max = var->getMax();
+      const bool        bound = var->hasMin() && var->hasMax();
+      double            val   = var->getVal();
+
+      if( p == 0 ){
+        // Keeping the present values as the first entry.
+      } else if( usegrid && bound && p <= ngridpoints ){
+        const unsigned j = std::find( bounded.begin(), bounded.end(), i )
+                           -bounded.begin();
+        val = min+( gridcell[i]+0.5 ) * ( max-min ) / gridsize[j];
+      } else if( usegrid && bound && !latin.empty() ){
+        val = min+( latin[i][p-1]+rand.Rndm() ) * ( max-min ) / ( npoints-1 );
+      } else {
+        const double width = var->getError() > 0 ? var->getError() :
+                             bound ? 0.1 * ( max-min ) :
+                             val != 0 ? 0.1 * std::fabs( val ) :
+                             1.0;
+        val = rand.Gaus( val, width );
+        if( var->hasMin() ){ val = std::max( val, min ); }
+        if( var->hasMax() ){ val = std::min( val, max ); }
+      }
+      start[p * ndim+i] = val;
+    }
+  }
+
+  // Running the fits from each of the initial parameter sets.
+  std::vector<std::unique_ptr<RooFitResult> > results( npoints );
+
+  for( unsigned p = 0; p < npoints; ++p ){
+    for( unsigned i = 0; i < ndim; ++i ){
+      floating[i]->setVal( start[p * ndim+i] );
+    }
+
+    results[p].reset( FitPDFToData( pdf, data, args ) );
+  }
+
+  // Selecting the best results.
+  int best = -1;
+
+  for( unsigned p = 0; p < npoints; ++p ){
+    if( !results[p] || results[p]->status() != 0 ){ continue; }
+    if( best < 0 || results[p]->minNll() < results[best]->minNll() ){
+      best = p;
+    }
+  }
+
+  if( best < 0 ){
+    for( unsigned p = 0; p < npoints; ++p ){
+      if( !results[p] ){ continue; }
+      if( best < 0 || results[p]->minNll() < results[best]->minNll() ){
+        best = p;
+      }
+    }
+  }
+
+  if( best < 0 ){ return nullptr; }
+
+  // Setting the original parameters to the best fit results.
+  for( const auto arg : results[best]->floatParsFinal() ){
+    const RooRealVar* fit = static_cast<const RooRealVar*>( arg );
+    RooRealVar*       var = dynamic_cast<RooRealVar*>(
+      params->find( fit->GetName() ) );
+    if( !var ){ continue; }
+    var->setVal( fit->getVal() );
+    var->setError( fit->getError() );
+    if( fit->hasAsymError() ){
+      var->setAsymError( fit->getAsymErrorLo(), fit->getAsymErrorHi() );
+    }
+  }
+
+  return results[best].release();
+}
+
+
 extern TH1D*
 TH1DFromRooData( RooAbsData&                   data,
                  const RooAbsRealLValue &      xvar,
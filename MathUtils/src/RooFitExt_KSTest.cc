@@ -5,18 +5,27 @@
  */
 
 #ifdef CMSSW_GIT_HASH
+#include "UserUtils/Common/interface/RootUtils/RooArgContainer.hpp"
+#include "UserUtils/Common/interface/SystemUtils/Thread.hpp"
+#include "UserUtils/MathUtils/interface/RandomUtils.hpp"
 #include "UserUtils/MathUtils/interface/RooFitExt.hpp"
 #else
+#include "UserUtils/Common/RootUtils/RooArgContainer.hpp"
+#include "UserUtils/Common/SystemUtils/Thread.hpp"
+#include "UserUtils/MathUtils/RandomUtils.hpp"
 #include "UserUtils/MathUtils/RooFitExt.hpp"
 #endif
 
 #include <RooAbsData.h>
 #include <RooAbsPdf.h>
 #include <RooDataSet.h>
+#include <RooFitResult.h>
 #include <RooRealVar.h>
 #include <TMath.h>
 
 #include <boost/format.hpp>
+#include <algorithm>
+#include <cmath>
 #include <memory>
 
 namespace usr
@@ -54,6 +63,7 @@ struct SimplifiedData
                   RooRealVar&      x,
                   const RooCmdArg& cut1,
                   const RooCmdArg& cut2 );
+  SimplifiedData( std::vector<Evt>&& list );
 };
 
 /**
@@ -93,28 +103,68 @@ struct SimplifiedData
  *
  * While this scheme readily extends to arbitrarily many ranges, our
  * implementation, would only allow for two ranges.
+ *
+ * As evaluating the RooFit CDF object requires the evaluation of an integral,
+ * the CDF is tabulated once on construction, and the values of the CDF are
+ * obtained by monotonic interpolation of the table. See the
+ * SimplifiedCDF::BuildTable method for details.
  */
 struct SimplifiedCDF
 {
   std::unique_ptr<RooAbsReal> rawcdf;
   RooRealVar& var;
   std::vector<std::pair<double, double> > rangelist;
+  std::vector<std::pair<double, double> > rawrange;
   double norm;
 
+  // Tabulated CDF values for monotonic interpolation
+  std::vector<double> gridx;
+  std::vector<double> gridy;
+  std::vector<double> gridd;
+  size_t hint;
+
   double operator()( const double x );
   double rawval( const double x );
+  double exactval( const double x );
+  void   BuildTable( const double tolerance );
+  double Invert( const double u ) const;
 
   inline double min( unsigned x ){ return rangelist.at( x ).first; }
   inline double max( unsigned x ){ return rangelist.at( x ).second; }
   SimplifiedCDF( RooAbsPdf&       pdf,
                  RooRealVar&      x,
                  const RooCmdArg& cut1,
-                 const RooCmdArg& cut2 );
+                 const RooCmdArg& cut2,
+                 const double     tolerance );
   void AddRange( const RooCmdArg& cmd );
 };
 
 bool CheckCutCmd( const RooCmdArg& cmd, RooRealVar& x );
 
+template<typename CDF>
+static double KSDistanceCore( const SimplifiedData& sim, CDF& cdf );
+static double KSDistanceCore( const SimplifiedData& sim1,
+                              const SimplifiedData& sim2 );
+static void KSCutArgs( const RooArgContainer& args,
+                       RooCmdArg&             cut1,
+                       RooCmdArg&             cut2 );
+static double KSCDFTolerance( const RooArgContainer& args );
+static size_t RandomIndex( usr::rng::Stream& rand, const size_t n );
+
+
+USERUTILS_COMMON_REGISTERCMD( KSTolerance );
+
+/**
+ * @brief Absolute tolerance of the tabulated CDF used for the
+ * Kolmogorov--Smirnov test of data sets against PDFs (default 1e-6).
+ *
+ * The tabulation of the CDF is refined until the tabulated values differ from
+ * the exact CDF by less than this value at the interval midpoints. Setting
+ * this to 0 (or a negative value) disables the tabulation, and the exact
+ * CDF is evaluated for every data point instead.
+ */
+RooCmdArg KSTolerance( const double x )
+{ return RooCmdArg( "KSTolerance", 0, 0, x ); }
 
 /**
  * @brief Calculating the Kolmogorov--Smirov distance of a RooDataSet and a
@@ -126,30 +176,23 @@ bool CheckCutCmd( const RooCmdArg& cmd, RooRealVar& x );
  *  - Up to two cuts in the data set. Currently you can only cut by specifying
  *    a range already declared in the variable of comparison. To see how
  *    the cumulative PDF is handled, see the helper class SimplifiedCDF.
+ *
+ * The tolerance of the tabulated CDF can be set by passing a
+ * usr::KSTolerance argument in any of the argument slots.
  */
 double
 KSDistance( RooDataSet&      dataset,
             RooAbsPdf&       pdf,
             RooRealVar&      var,
             const RooCmdArg& cut1,
-            const RooCmdArg& cut2 )
+            const RooCmdArg& cut2,
+            const RooCmdArg& arg3 )
 {
-  SimplifiedData sim( dataset, var, cut1, cut2 );
-  SimplifiedCDF  cdf( pdf, var, cut1, cut2 );
-
-  double empcdf  = 0;
-  double maxdist = 0;
-
-  for( const auto& evt : sim.dataset ){
-    // emperical cdf is the sum of weights
-    // (normalization handled latter for stability )
-    const double val = evt.first;
-    const double wgt = evt.second;
-    empcdf += wgt;
-    maxdist = std::max( maxdist, fabs( cdf( val )-( empcdf / sim.sum ) ) );
-  }
+  const RooArgContainer args( std::vector<RooCmdArg>( { cut1, cut2, arg3 } ) );
+  SimplifiedData        sim( dataset, var, cut1, cut2 );
+  SimplifiedCDF         cdf( pdf, var, cut1, cut2, KSCDFTolerance( args ) );
 
-  return sqrt( sim.EffectiveNum() ) * maxdist;
+  return KSDistanceCore( sim, cdf );
 }
 
 
@@ -165,9 +208,10 @@ KSProb( RooDataSet&      dataset,
         RooAbsPdf&       pdf,
         RooRealVar&      var,
         const RooCmdArg& cut1,
-        const RooCmdArg& cut2 )
+        const RooCmdArg& cut2,
+        const RooCmdArg& arg3 )
 {
-  const double dist = KSDistance( dataset, pdf, var, cut1, cut2 );
+  const double dist = KSDistance( dataset, pdf, var, cut1, cut2, arg3 );
   return TMath::KolmogorovProb( dist );
 }
 
@@ -191,6 +235,310 @@ KSDistance( RooDataSet&      set1,
   SimplifiedData sim1( set1, var, cut1, cut2 );
   SimplifiedData sim2( set2, var, cut1, cut2 );
 
+  return KSDistanceCore( sim1, sim2 );
+}
+
+
+/**
+ * @brief Returning the KS probability of two data sets
+ * @details this takes the KS distance of the two datasets and pass it directly
+ * to the TMath::KolmogorovProb() functions.
+ */
+double
+KSProb( RooDataSet&      set1,
+        RooDataSet&      set2,
+        RooRealVar&      var,
+        const RooCmdArg& cut1,
+        const RooCmdArg& cut2 )
+{
+  const double dist = KSDistance( set1, set2, var, cut1, cut2 );
+  return TMath::KolmogorovProb( dist );
+}
+
+
+/**
+ * @brief An alternative, effective p-value of the KS test for two data set.
+ * @details the alternative calculation is described in
+   [this](
+ * https://en.wikipedia.org/wiki/Kolmogorov%E2%80%93Smirnov_test#Two-sample_Kolmogorov%E2%80%93Smirnov_test)
+ * page.
+   Hard limiting the calculation output to 1 for a more "sane" output value
+ */
+double
+KSProbAlt( RooDataSet&      set1,
+           RooDataSet&      set2,
+           RooRealVar&      var,
+           const RooCmdArg& cut1,
+           const RooCmdArg& cut2 )
+{
+  const double dist = KSDistance( set1, set2, var, cut1, cut2 );
+
+  // Alternative calculation of p-value as described in wiki page
+  return std::min( exp( -2. * dist * dist ) * 2., 1. );
+}
+
+
+USERUTILS_COMMON_REGISTERCMD( NumToys );
+
+/**
+ * @brief Number of pseudo-experiments to generate for the usr::KSToyProb
+ * functions (default 1000), and the seed used for the random number
+ * generation.
+ */
+RooCmdArg NumToys( const unsigned n, const unsigned seed )
+{ return RooCmdArg( "NumToys", n, seed ); }
+
+USERUTILS_COMMON_REGISTERCMD( RefitToys );
+
+/**
+ * @brief Whether the PDF should be refitted to each of the pseudo-experiment
+ * before calculating the KS distance in the usr::KSToyProb functions.
+ */
+RooCmdArg RefitToys( const bool x )
+{ return RooCmdArg( "RefitToys", x ); }
+
+
+/**
+ * @brief KS test p-value of a data set against a PDF, estimated from
+ * pseudo-experiments.
+ *
+ * The asymptotic Kolmogorov distribution used in the KSProb functions is only
+ * valid for unweighted data sets compared to a PDF whose parameters are fixed
+ * before seeing the data. Here the p-value is instead estimated as the
+ * fraction of pseudo-experiments whose KS distance is greater than or equal to
+ * that of the data, with the Clopper--Pearson interval used as the
+ * uncertainty. The pseudo-experiments contain the same number of entries as
+ * the data set (after cuts); for weighted data sets, the weights of the
+ * pseudo-experiment entries are resampled from the weights of the data set.
+ *
+ * The following options are accepted:
+ * - `usr::NumToys( n, seed )`: the number of pseudo-experiments and the seed
+ *   of the random number generation. Each pseudo-experiment uses its own
+ *   usr::rng::Stream, with the seed and the pseudo-experiment index as the
+ *   stream identifier, so results do not depend on the number of threads.
+ * - `usr::RefitToys()`: Fitting the PDF to each pseudo-experiment before
+ *   computing the KS distance, which is needed if the PDF parameters were
+ *   extracted from the data set. The pseudo-experiments are generated from
+ *   the PDF with the present parameter values, and all other options
+ *   (excluding the options listed here) are passed to the fit routine
+ *   usr::FitPDFToData. RooFit fits are not thread safe, so the
+ *   pseudo-experiments are processed one after another in the calling thread,
+ *   and the PDF parameters are restored afterwards. Without this option, the
+ *   KS distance of each pseudo-experiment is computed directly from the
+ *   transformed uniform values, which doesn't require any RooFit evaluation.
+ * - `usr::NumThreads( n )`: the maximum number of threads to use for the
+ *   pseudo-experiments that are not refitted.
+ * - `RooFit::CutRange( "range1,range2" )`: Up to two ranges of the variable
+ *   to perform the test on (see the KSDistance functions).
+ * - `usr::KSTolerance( x )`: the tolerance of the tabulated CDF used for the
+ *   KS distance of the data set and the refitted pseudo-experiments.
+ */
+Measurement
+KSToyProb( RooDataSet&                   dataset,
+           RooAbsPdf&                    pdf,
+           RooRealVar&                   var,
+           const std::vector<RooCmdArg>& cmdargs )
+{
+  const RooArgContainer args( cmdargs, { NumToys( 1000 ) } );
+  const unsigned        ntoys   = std::max( args.GetInt( "NumToys", 0 ), 1 );
+  const unsigned        seed    = args.GetInt( "NumToys", 1 );
+  const unsigned        nthread = args.Has( "NumThreads" ) ?
+                                  args.GetInt( "NumThreads" ) :
+                                  0;
+  const bool refit = args.Has( "RefitToys" ) && args.GetInt( "RefitToys" );
+
+  RooCmdArg cut1 = RooCmdArg::none();
+  RooCmdArg cut2 = RooCmdArg::none();
+  KSCutArgs( args, cut1, cut2 );
+
+  const double   tolerance = KSCDFTolerance( args );
+  SimplifiedData sim( dataset, var, cut1, cut2 );
+  SimplifiedCDF  cdf( pdf, var, cut1, cut2, tolerance );
+  const double   observed = KSDistanceCore( sim, cdf );
+  const size_t   nevt     = sim.dataset.size();
+  const bool     weighted = sim.sum != sim.sumsq;
+
+  if( refit && cdf.gridx.empty() ){
+    // Generation always require the tabulated CDF.
+    cdf.BuildTable( 1e-6 );
+  }
+
+  std::vector<double> toydist( ntoys );
+
+  if( !refit ){
+    usr::ParallelFor( ntoys, nthread, [&]( const size_t t, const unsigned ){
+      usr::rng::Stream rand( seed, t );
+      std::vector<SimplifiedData::Evt> list;
+      list.reserve( nevt );
+
+      for( size_t i = 0; i < nevt; ++i ){
+        const double u = rand.Uniform();
+        list.emplace_back( u, weighted ?
+                           sim.dataset[RandomIndex( rand, nevt )].second :
+                           1.0 );
+      }
+
+      SimplifiedData toy( std::move( list ) );
+      auto           uniform = []( const double u ){ return u; };
+      toydist[t] = KSDistanceCore( toy, uniform );
+    } );
+  } else {
+    std::unique_ptr<RooArgSet>  params( pdf.getParameters( RooArgSet( var ) ) );
+    std::unique_ptr<RooArgSet>  init( (RooArgSet*)params->snapshot() );
+    const double                varinit = var.getVal();
+    RooRealVar                  weightvar( "kstoy_weight", "", 1 );
+    std::unique_ptr<RooDataSet> toyset(
+      weighted ?
+      new RooDataSet( "kstoy", "", RooArgSet( var, weightvar ),
+                      RooFit::WeightVar( weightvar ) ) :
+      new RooDataSet( "kstoy", "", RooArgSet( var ) ) );
+
+    std::vector<RooCmdArg> fitargs;
+
+    for( const auto& arg : args ){
+      if( std::string( arg.GetName() ) != "CutRange"
+          && std::string( arg.GetName() ) != "KSTolerance" ){
+        fitargs.push_back( arg );
+      }
+    }
+
+    for( size_t t = 0; t < ntoys; ++t ){
+      usr::rng::Stream rand( seed, t );
+      toyset->reset();
+
+      for( size_t i = 0; i < nevt; ++i ){
+        var = cdf.Invert( rand.Uniform() );
+        if( weighted ){
+          toyset->add( RooArgSet( var ),
+                       sim.dataset[RandomIndex( rand, nevt )].second );
+        } else {
+          toyset->add( RooArgSet( var ) );
+        }
+      }
+
+      *params = *init;
+      delete FitPDFToData( pdf, *toyset, fitargs );
+      toydist[t] = KSDistance( *toyset, pdf, var, cut1, cut2,
+                               KSTolerance( tolerance ) );
+    }
+
+    *params = *init;
+    var     = varinit;
+  }
+
+  const unsigned npass = std::count_if( toydist.begin(), toydist.end(),
+                                        [observed]( const double d ){
+    return d >= observed;
+  } );
+
+  return Efficiency::ClopperPearson( npass, ntoys );
+}
+
+
+/**
+ * @brief KS test p-value of two data sets, estimated from pseudo-experiments.
+ *
+ * The pseudo-experiments are generated by resampling (with replacement) the
+ * pooled entries of the two data sets (after cuts) into two data sets of the
+ * original sizes, so that the weights of the data sets are also accounted for.
+ * The p-value is the fraction of pseudo-experiments whose KS distance is
+ * greater than or equal to that of the data, with the Clopper--Pearson
+ * interval used as the uncertainty. The `usr::NumToys`, `usr::NumThreads` and
+ * `RooFit::CutRange` options are accepted, with the same meaning as the
+ * data--PDF version of this function.
+ */
+Measurement
+KSToyProb( RooDataSet&                   set1,
+           RooDataSet&                   set2,
+           RooRealVar&                   var,
+           const std::vector<RooCmdArg>& cmdargs )
+{
+  const RooArgContainer args( cmdargs, { NumToys( 1000 ) } );
+  const unsigned        ntoys   = std::max( args.GetInt( "NumToys", 0 ), 1 );
+  const unsigned        seed    = args.GetInt( "NumToys", 1 );
+  const unsigned        nthread = args.Has( "NumThreads" ) ?
+                                  args.GetInt( "NumThreads" ) :
+                                  0;
+
+  RooCmdArg cut1 = RooCmdArg::none();
+  RooCmdArg cut2 = RooCmdArg::none();
+  KSCutArgs( args, cut1, cut2 );
+
+  const SimplifiedData sim1( set1, var, cut1, cut2 );
+  const SimplifiedData sim2( set2, var, cut1, cut2 );
+  const double         observed = KSDistanceCore( sim1, sim2 );
+  const size_t         n1       = sim1.dataset.size();
+  const size_t         n2       = sim2.dataset.size();
+
+  std::vector<SimplifiedData::Evt> pool( sim1.dataset );
+  pool.insert( pool.end(), sim2.dataset.begin(), sim2.dataset.end() );
+
+  std::vector<double> toydist( ntoys );
+
+  usr::ParallelFor( ntoys, nthread, [&]( const size_t t, const unsigned ){
+    usr::rng::Stream rand( seed, t );
+    std::vector<SimplifiedData::Evt> list1;
+    std::vector<SimplifiedData::Evt> list2;
+    list1.reserve( n1 );
+    list2.reserve( n2 );
+
+    for( size_t i = 0; i < n1; ++i ){
+      list1.push_back( pool[RandomIndex( rand, pool.size() )] );
+    }
+
+    for( size_t i = 0; i < n2; ++i ){
+      list2.push_back( pool[RandomIndex( rand, pool.size() )] );
+    }
+
+    toydist[t] = KSDistanceCore( SimplifiedData( std::move( list1 ) ),
+                                 SimplifiedData( std::move( list2 ) ) );
+  } );
+
+  const unsigned npass = std::count_if( toydist.begin(), toydist.end(),
+                                        [observed]( const double d ){
+    return d >= observed;
+  } );
+
+  return Efficiency::ClopperPearson( npass, ntoys );
+}
+
+
+/*-----------------------------------------------------------------------------
+ *  Helper functions
+   --------------------------------------------------------------------------*/
+
+/**
+ * @brief KS distance of a simplified data set against a CDF function object.
+ *
+ * The data set is assumed to be sorted, and the CDF function is called in
+ * increasing order.
+ */
+template<typename CDF>
+static double
+KSDistanceCore( const SimplifiedData& sim, CDF& cdf )
+{
+  double empcdf  = 0;
+  double maxdist = 0;
+
+  for( const auto& evt : sim.dataset ){
+    // emperical cdf is the sum of weights
+    // (normalization handled latter for stability )
+    const double val = evt.first;
+    const double wgt = evt.second;
+    empcdf += wgt;
+    maxdist = std::max( maxdist, fabs( cdf( val )-( empcdf / sim.sum ) ) );
+  }
+
+  return sqrt( sim.EffectiveNum() ) * maxdist;
+}
+
+
+/**
+ * @brief KS distance between two sorted simplified data sets.
+ */
+static double
+KSDistanceCore( const SimplifiedData& sim1, const SimplifiedData& sim2 )
+{
   double empcdf1 = 0;
   double empcdf2 = 0;
   double maxdist = 0;
@@ -206,12 +554,12 @@ KSDistance( RooDataSet&      set1,
     } else {// special case for identical value
       double x = evt1->first;
 
-      while( evt1->first == x && evt1 != sim1.dataset.end() ){
+      while( evt1 != sim1.dataset.end() && evt1->first == x ){
         empcdf1 += evt1->second;
         evt1++;
       }
 
-      while( evt2->first == x && evt2 != sim2.dataset.end() ){
+      while( evt2 != sim2.dataset.end() && evt2->first == x ){
         empcdf2 += evt2->second;
         evt2++;
       }
@@ -228,41 +576,41 @@ KSDistance( RooDataSet&      set1,
 
 
 /**
- * @brief Returning the KS probability of two data sets
- * @details this takes the KS distance of the two datasets and pass it directly
- * to the TMath::KolmogorovProb() functions.
+ * @brief Extracting up to two cut range arguments from a
+ * `RooFit::CutRange( "range1,range2" )` argument.
  */
-double
-KSProb( RooDataSet&      set1,
-        RooDataSet&      set2,
-        RooRealVar&      var,
-        const RooCmdArg& cut1,
-        const RooCmdArg& cut2 )
+static void
+KSCutArgs( const RooArgContainer& args, RooCmdArg& cut1, RooCmdArg& cut2 )
 {
-  const double dist = KSDistance( set1, set2, var, cut1, cut2 );
-  return TMath::KolmogorovProb( dist );
+  if( !args.Has( "CutRange" ) ){ return; }
+
+  const std::string ranges = args.GetStr( "CutRange" );
+  const size_t      comma  = ranges.find( ',' );
+  cut1 = RooFit::CutRange( ranges.substr( 0, comma ).c_str() );
+  if( comma != std::string::npos ){
+    cut2 = RooFit::CutRange( ranges.substr( comma+1 ).c_str() );
+  }
 }
 
 
 /**
- * @brief An alternative, effective p-value of the KS test for two data set.
- * @details the alternative calculation is described in
-   [this](
- * https://en.wikipedia.org/wiki/Kolmogorov%E2%80%93Smirnov_test#Two-sample_Kolmogorov%E2%80%93Smirnov_test)
- * page.
-   Hard limiting the calculation output to 1 for a more "sane" output value
+ * @brief Tolerance of the tabulated CDF from a usr::KSTolerance argument,
+ * defaulting to 1e-6.
  */
-double
-KSProbAlt( RooDataSet&      set1,
-           RooDataSet&      set2,
-           RooRealVar&      var,
-           const RooCmdArg& cut1,
-           const RooCmdArg& cut2 )
+static double
+KSCDFTolerance( const RooArgContainer& args )
 {
-  const double dist = KSDistance( set1, set2, var, cut1, cut2 );
+  return args.Has( "KSTolerance" ) ? args.GetDouble( "KSTolerance" ) : 1e-6;
+}
 
-  // Alternative calculation of p-value as described in wiki page
-  return std::min( exp( -2. * dist * dist ) * 2., 1. );
+
+/**
+ * @brief Random index in [0, n) for resampling entries of a data set.
+ */
+static size_t
+RandomIndex( usr::rng::Stream& rand, const size_t n )
+{
+  return std::min( size_t( rand.Uniform() * n ), n-1 );
 }
 
 
@@ -294,8 +642,15 @@ SimplifiedData::SimplifiedData( RooDataSet&      data,
     sum = sumsq = op_set->numEntries();
   }
 
+  // The data set loads each entry into the same row object, so the variable
+  // only needs to be looked up by name once.
+  const RooAbsReal* xval = dynamic_cast<const RooAbsReal*>(
+    op_set->get()->find( x.GetName() ) );
+  dataset.reserve( op_set->numEntries() );
+
   for( int i = 0; i < op_set->numEntries(); ++i ){
-    const double d = op_set->get( i )->getRealValue( x.GetName() );
+    op_set->get( i );
+    const double d = xval->getVal();
     const double w = op_set->weight();
     if( !op_set->isWeighted() ){
       dataset.push_back( std::pair<double, double>( d, 1 ) );
@@ -313,6 +668,24 @@ SimplifiedData::SimplifiedData( RooDataSet&      data,
 }
 
 
+/**
+ * @brief Constructing the simplified data set directly from a list of
+ * entries, used for the generation of pseudo-experiments.
+ */
+SimplifiedData::SimplifiedData( std::vector<Evt>&& list ) :
+  sum    ( 0 ),
+  sumsq  ( 0 ),
+  dataset( std::move( list ) )
+{
+  for( const auto& evt : dataset ){
+    sum   += evt.second;
+    sumsq += evt.second * evt.second;
+  }
+
+  std::sort( dataset.begin(), dataset.end(), Compare );
+}
+
+
 /*----------------------------------------------------------------------------*/
 
 double
@@ -334,9 +707,11 @@ SimplifiedData::EffectiveNum() const
 SimplifiedCDF::SimplifiedCDF( RooAbsPdf&       pdf,
                               RooRealVar&      x,
                               const RooCmdArg& cut1,
-                              const RooCmdArg& cut2 ) :
+                              const RooCmdArg& cut2,
+                              const double     tolerance ) :
   rawcdf( pdf.createCdf( RooArgSet( x ) ) ),
-  var   ( x )
+  var   ( x ),
+  hint  ( 0 )
 {
   if( CheckCutCmd( cut1, var ) ){ AddRange( cut1 ); }
   if( CheckCutCmd( cut2, var ) ){ AddRange( cut2 ); }
@@ -356,14 +731,24 @@ SimplifiedCDF::SimplifiedCDF( RooAbsPdf&       pdf,
     }
   }
 
-  // Saving normalization denominator
+  if( tolerance > 0 ){
+    BuildTable( tolerance );
+  }
+
+  // Saving the raw CDF values at the range edges and the normalization
+  // denominator (should be 1 if no ranges are specified)
   if( rangelist.size() == 0 ){
-    norm = rawval( var.getMax() )-rawval( var.getMin() );   // Should be 1
-  } else if( rangelist.size() == 1 ){
-    norm = rawval( max( 0 ) )-rawval( min( 0 ) );
-  } else {
-    norm = ( rawval( max( 0 ) )-rawval( min( 0 ) ) )
-           +( rawval( max( 1 ) )-rawval( min( 1 ) ) );
+    rawrange.emplace_back( rawval( var.getMin() ), rawval( var.getMax() ) );
+  }
+
+  for( const auto& range : rangelist ){
+    rawrange.emplace_back( rawval( range.first ), rawval( range.second ) );
+  }
+
+  norm = 0;
+
+  for( const auto& range : rawrange ){
+    norm += range.second-range.first;
   }
 }
 
@@ -375,21 +760,23 @@ SimplifiedCDF::SimplifiedCDF( RooAbsPdf&       pdf,
 double
 SimplifiedCDF::operator()( const double x )
 {
-  double ans = rawval( x );
+  // The raw CDF values at the range edges are taken from the cached rawrange
+  // values, such that the table look up hint is not reset with every call.
+  const double ans = rawval( x );
   if( rangelist.size() == 0 ){
     return ans;
   } else if( rangelist.size() == 1 ){
     if( min( 0 ) < x && x < max( 0 ) ){
-      return ( ans-rawval( min( 0 ) ) ) / norm;
+      return ( ans-rawrange[0].first ) / norm;
     } else {
       return ans;
     }
   } else {
     if( min( 0 ) < x && x < max( 0 ) ){
-      return ( ans-rawval( min( 0 ) ) ) / norm;
+      return ( ans-rawrange[0].first ) / norm;
     } else if( min( 1 ) < x && x < max( 1 ) ){
-      return ( ans-rawval( min( 1 ) )
-               +( rawval( max( 0 ) )-rawval( min( 0 ) ) ) ) / norm;
+      return ( ans-rawrange[1].first
+               +( rawrange[0].second-rawrange[0].first ) ) / norm;
     } else {
       return ans;
     }
@@ -399,15 +786,194 @@ SimplifiedCDF::operator()( const double x )
 
 /**
  * @brief returning the raw CDF functions value as constructed by RooFit.
+ *
+ * If the CDF has been tabulated, the value is obtained by the monotonic cubic
+ * Hermite interpolation of the table. As the KS test evaluates the CDF in
+ * increasing order, the table look up starts from the interval of the
+ * previous call.
  */
 double
 SimplifiedCDF::rawval( const double x )
+{
+  if( gridx.empty() ){
+    return exactval( x );
+  }
+
+  if( x <= gridx.front() ){ return gridy.front(); }
+  if( x >= gridx.back() ){ return gridy.back(); }
+
+  if( x < gridx[hint] ){
+    hint = std::upper_bound( gridx.begin(), gridx.end(), x )-gridx.begin()-1;
+  } else {
+    while( gridx[hint+1] < x ){
+      ++hint;
+    }
+  }
+
+  const double h  = gridx[hint+1]-gridx[hint];
+  const double t  = ( x-gridx[hint] ) / h;
+  const double t2 = t * t;
+  const double t3 = t2 * t;
+
+  return ( 2 * t3-3 * t2+1 ) * gridy[hint]
+         +( t3-2 * t2+t ) * h * gridd[hint]
+         +( -2 * t3+3 * t2 ) * gridy[hint+1]
+         +( t3-t2 ) * h * gridd[hint+1];
+}
+
+
+/**
+ * @brief Exact evaluation of the CDF function as constructed by RooFit.
+ */
+double
+SimplifiedCDF::exactval( const double x )
 {
   var = x;
   return rawcdf->getVal();
 }
 
 
+/**
+ * @brief Tabulating the CDF function on an adaptive grid.
+ *
+ * The grid starts with uniformly spaced nodes across the full variable range,
+ * together with the edges of the requested cut ranges. Each interval is then
+ * recursively bisected until the linear interpolation of the interval
+ * endpoints differ from the exact CDF value at the midpoint by less than the
+ * requested tolerance (the midpoint is always kept as a node). The slopes at
+ * the nodes are then computed using the Fritsch--Butland weighted harmonic
+ * mean, such that the resulting cubic Hermite interpolation is monotonic.
+ *
+ * The value of the variable is restored after the tabulation.
+ */
+void
+SimplifiedCDF::BuildTable( const double tolerance )
+{
+  static const unsigned ninit    = 64;
+  static const unsigned maxdepth = 24;
+
+  const double original = var.getVal();
+  const double xmin     = var.getMin();
+  const double xmax     = var.getMax();
+
+  std::vector<double> init;
+
+  for( unsigned i = 0; i <= ninit; ++i ){
+    init.push_back( xmin+( xmax-xmin ) * i / ninit );
+  }
+
+  for( const auto& range : rangelist ){
+    init.push_back( range.first );
+    init.push_back( range.second );
+  }
+
+  std::sort( init.begin(), init.end() );
+  init.erase( std::unique( init.begin(), init.end() ), init.end() );
+
+  gridx.clear();
+  gridy.clear();
+  gridx.push_back( init.front() );
+  gridy.push_back( exactval( init.front() ) );
+
+  // Depth first bisection, so that nodes are inserted in increasing order.
+  struct Interval
+  {
+    double   xb, yb;
+    unsigned depth;
+  };
+
+  for( unsigned i = 1; i < init.size(); ++i ){
+    std::vector<Interval> stack;
+    stack.push_back( { init[i], exactval( init[i] ), 0 } );
+
+    while( !stack.empty() ){
+      const Interval top = stack.back();
+      const double   xa  = gridx.back();
+      const double   ya  = gridy.back();
+      const double   xm  = ( xa+top.xb ) / 2;
+      const double   ym  = exactval( xm );
+
+      if( top.depth < maxdepth
+          && std::fabs( ym-( ya+top.yb ) / 2 ) > tolerance ){
+        stack.push_back( { xm, ym, top.depth+1 } );
+        stack[stack.size()-2].depth = top.depth+1;
+      } else {
+        gridx.push_back( xm );
+        gridy.push_back( ym );
+        gridx.push_back( top.xb );
+        gridy.push_back( top.yb );
+        stack.pop_back();
+      }
+    }
+  }
+
+  // Computing the slopes for monotonic interpolation
+  const size_t        n = gridx.size();
+  std::vector<double> delta( n-1 );
+
+  for( size_t i = 0; i+1 < n; ++i ){
+    delta[i] = ( gridy[i+1]-gridy[i] ) / ( gridx[i+1]-gridx[i] );
+  }
+
+  gridd.assign( n, 0.0 );
+  if( n > 1 ){
+    gridd.front() = std::max( delta.front(), 0.0 );
+    gridd.back()  = std::max( delta.back(), 0.0 );
+  }
+
+  for( size_t i = 1; i+1 < n; ++i ){
+    if( delta[i-1] <= 0 || delta[i] <= 0 ){
+      gridd[i] = 0;
+    } else {
+      const double h0 = gridx[i]-gridx[i-1];
+      const double h1 = gridx[i+1]-gridx[i];
+      const double w0 = 2 * h1+h0;
+      const double w1 = h1+2 * h0;
+      gridd[i] = ( w0+w1 ) / ( w0 / delta[i-1]+w1 / delta[i] );
+    }
+  }
+
+  hint = 0;
+  var  = original;
+}
+
+
+/**
+ * @brief Inverse of the effective CDF function, used for generating
+ * pseudo-experiments from uniform random numbers.
+ *
+ * The inversion uses the linear interpolation of the tabulated CDF values,
+ * so the CDF must already be tabulated. As this function doesn't modify the
+ * object, it can be safely be called from multiple threads.
+ */
+double
+SimplifiedCDF::Invert( const double u ) const
+{
+  double s = u * norm;
+  double y = rawrange.back().second;
+
+  for( const auto& range : rawrange ){
+    if( s <= range.second-range.first ){
+      y = range.first+s;
+      break;
+    }
+    s -= range.second-range.first;
+  }
+
+  const size_t n = gridy.size();
+  const size_t i = std::min( std::max<size_t>(
+                               std::upper_bound( gridy.begin(), gridy.end(), y )
+                               -gridy.begin(), 1 ), n-1 );
+
+  if( gridy[i] <= gridy[i-1] ){
+    return gridx[i-1];
+  } else {
+    return gridx[i-1]+( y-gridy[i-1] ) / ( gridy[i]-gridy[i-1] )
+           * ( gridx[i]-gridx[i-1] );
+  }
+}
+
+
 /*----------------------------------------------------------------------------*/
 
 void
@@ -1,15 +1,39 @@
 #ifdef CMSSW_GIT_HASH
+#include "UserUtils/Common/interface/STLUtils/StringUtils.hpp"
+#include "UserUtils/Common/interface/SystemUtils/Thread.hpp"
 #include "UserUtils/MathUtils/interface/RootMathTools/RootFit.hpp"
 #else
+#include "UserUtils/Common/STLUtils/StringUtils.hpp"
+#include "UserUtils/Common/SystemUtils/Thread.hpp"
 #include "UserUtils/MathUtils/RootMathTools/RootFit.hpp"
 #endif
 
+#include "Fit/DataRange.h"
+#include "Foption.h"
+#include "HFitInterface.h"
+#include "Math/MinimizerOptions.h"
+#include "RooGlobalFunc.h"
+#include "TGraphErrors.h"
+#include "TROOT.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+
 namespace usr
 {
 
 namespace fit
 {
 
+static ScanResult RunGraphScan(
+  TGraph&,
+  TF1&,
+  const size_t,
+  const std::vector<RooCmdArg>&,
+  const std::function<void( size_t, TF1&, std::vector<RooCmdArg>&,
+                            double& )>& );
+
 /**
  * @details Here we unfold the RooCmdArgs into the standard strings of the
  * vanilla ROOT fit routine:
@@ -24,6 +48,10 @@ namespace fit
  *
  * The Fit Range is also now specified by an argument
  *
+ * The minimizer can be specified for this fit only using the
+ * `RooFit::Minimizer( type, algo )` argument, otherwise the ROOT default
+ * minimizer is used.
+ *
  * All other options strings will be omitted.
  */
 extern TFitResult
@@ -63,8 +91,230 @@ FitGraph( TGraph& g, TF1& f, const std::vector<RooCmdArg>& arglist )
 
   const std::string root_str = save_str+verb_str+minos_str+more_str+err_str;
 
-  // Running the fit, de-reference the TFitResultPtr class.
-  return *( g.Fit( &f, root_str.c_str(), "", xmin, xmax ).Get());
+  if( !args.Has( "Minimizer" ) ){
+    // Running the fit, de-reference the TFitResultPtr class.
+    return *( g.Fit( &f, root_str.c_str(), "", xmin, xmax ).Get());
+  }
+
+  // Same as TGraph::Fit, but with the minimizer options of this fit only.
+  const RooCmdArg&             minarg = args.Get( "Minimizer" );
+  ROOT::Math::MinimizerOptions minopt;
+  Foption_t                    fitopt;
+  ROOT::Fit::DataRange         range( xmin, xmax );
+  minopt.SetMinimizerType( minarg.getString( 0 ) );
+  if( minarg.getString( 1 ) ){
+    minopt.SetMinimizerAlgorithm( minarg.getString( 1 ) );
+  }
+  ROOT::Fit::FitOptionsMake( ROOT::Fit::EFitObjectType::kGraph,
+                             root_str.c_str(), fitopt );
+
+  return *( ROOT::Fit::FitObject( &g, &f, fitopt, minopt, "", range ).Get() );
+}
+
+
+//-------------------------------------------------------------------------------
+
+/**
+ * @brief Scanning the fit of a graph over a list of fixed values of a
+ * function parameter.
+ *
+ * For each scan point, the parameter `ipar` is fixed to the scan value, while
+ * all other parameters start from the present values of the function. The
+ * function parameters are not modified by the scan, and the minimum of the
+ * objective function for each scan point can be used to construct the profile
+ * curve of the parameter (see ScanResult::MakeGraph).
+ *
+ * The scan points are evaluated in parallel, see the RunGraphScan function for
+ * details. All arguments are passed to the FitGraph function, with the
+ * exception that Minos is not run unless RunMinos is explicitly specified.
+ */
+extern ScanResult
+ScanGraphParam( TGraph&                       g,
+                TF1&                          f,
+                const unsigned                ipar,
+                const std::vector<double>&    values,
+                const std::vector<RooCmdArg>& arglist )
+{
+  return RunGraphScan( g, f, values.size(), arglist,
+                       [&]( const size_t i, TF1& func,
+                            std::vector<RooCmdArg>&, double& x ){
+    func.FixParameter( ipar, values[i] );
+    x = values[i];
+  } );
+}
+
+
+/**
+ * @brief Scanning the fit of a graph over a list of fit ranges.
+ *
+ * For each scan point, the function parameters start from the present values
+ * of the function, and the fit is performed in the given range (overriding any
+ * GraphXRange argument). The center of the range is used as the scan value of
+ * the results. See the ScanGraphParam function for the other details.
+ */
+extern ScanResult
+ScanGraphRange( TGraph&                                        g,
+                TF1&                                           f,
+                const std::vector<std::pair<double, double> >& ranges,
+                const std::vector<RooCmdArg>&                  arglist )
+{
+  return RunGraphScan( g, f, ranges.size(), arglist,
+                       [&]( const size_t i, TF1&,
+                            std::vector<RooCmdArg>& args, double& x ){
+    args.insert( args.begin(),
+                 GraphXRange( ranges[i].first, ranges[i].second ) );
+    x = ( ranges[i].first+ranges[i].second ) / 2;
+  } );
+}
+
+
+/**
+ * @brief Common routine for running the scan points of a graph fit.
+ *
+ * The fits are dispatched to a pool of worker threads (see usr::NumThreads),
+ * each owning a clone of the graph and the function created in the calling
+ * thread. Before each scan point, the parameters and parameter limits of the
+ * worker function are reset to those of the original function, and the
+ * `setup` function is called to modify the function or the fit arguments
+ * for the scan point.
+ *
+ * As the TMinuit minimizer used by default in ROOT fits is not re-entrant, the
+ * fits default to `RooFit::Minimizer( "Minuit2", "Migrad" )` unless a
+ * minimizer is specified. The global ROOT minimizer defaults are not modified.
+ */
+static ScanResult
+RunGraphScan( TGraph&                                          g,
+              TF1&                                             f,
+              const size_t                                     npoints,
+              const std::vector<RooCmdArg>&                    arglist,
+              const std::function<void( size_t, TF1&,
+                                        std::vector<RooCmdArg>&,
+                                        double& )>& setup )
+{
+  const RooArgContainer args( arglist, {
+        RunMinos( false ), RooFit::Minimizer( "Minuit2", "Migrad" )
+      } );
+  const unsigned        nthread = args.Has( "NumThreads" ) ?
+                                  args.GetInt( "NumThreads" ) :
+                                  0;
+  const unsigned npar = f.GetNpar();
+
+  std::vector<RooCmdArg> fitargs;
+
+  for( const auto& arg : args ){
+    if( std::string( arg.GetName() ) != "NumThreads" ){
+      fitargs.push_back( arg );
+    }
+  }
+
+  // Storing the initial parameters
+  std::vector<double> init( npar );
+  std::vector<double> parmin( npar );
+  std::vector<double> parmax( npar );
+
+  for( unsigned i = 0; i < npar; ++i ){
+    init[i] = f.GetParameter( i );
+    f.GetParLimits( i, parmin[i], parmax[i] );
+  }
+
+  ScanResult result;
+  result.x.resize( npoints, 0 );
+  result.fcn.resize( npoints, 0 );
+  result.status.resize( npoints, -1 );
+  result.param.resize( npoints, std::vector<double>( npar, 0 ) );
+  result.error.resize( npoints, std::vector<double>( npar, 0 ) );
+
+  // Creating the per-worker clones in the calling thread.
+  const unsigned nworkers = usr::WorkerCount( nthread, npoints );
+  std::vector<std::unique_ptr<TGraph> > gclone;
+  std::vector<std::unique_ptr<TF1> >    fclone;
+
+  if( nworkers > 1 ){
+    ROOT::EnableThreadSafety();
+  }
+
+  for( unsigned w = 0; w < nworkers; ++w ){
+    gclone.emplace_back( static_cast<TGraph*>( g.Clone() ) );
+    fclone.emplace_back( static_cast<TF1*>(
+                           f.Clone( usr::RandomString( 6 ).c_str() ) ) );
+  }
+
+  usr::ParallelFor( npoints, nthread,
+                    [&]( const size_t p, const unsigned w ){
+    TF1&                   func  = *fclone[w];
+    std::vector<RooCmdArg> point = fitargs;
+
+    for( unsigned i = 0; i < npar; ++i ){
+      func.SetParameter( i, init[i] );
+      func.SetParLimits( i, parmin[i], parmax[i] );
+    }
+
+    setup( p, func, point, result.x[p] );
+
+    const TFitResult fit = FitGraph( *gclone[w], func, point );
+    result.fcn[p]    = fit.MinFcnValue();
+    result.status[p] = fit.Status();
+
+    for( unsigned i = 0; i < npar && i < fit.NPar(); ++i ){
+      result.param[p][i] = fit.Parameter( i );
+      result.error[p][i] = fit.ParError( i );
+    }
+  } );
+
+  return result;
+}
+
+
+/**
+ * @brief Profile curve of the scan: the minimum value of the objective
+ * function against the scan value for the converged scan points. If
+ * `subtract_min` is true, the smallest objective function value among the
+ * converged points is subtracted. The graph is owned by the caller.
+ */
+TGraph*
+ScanResult::MakeGraph( const bool subtract_min ) const
+{
+  double minfcn = 0;
+
+  if( subtract_min ){
+    bool found = false;
+
+    for( size_t i = 0; i < x.size(); ++i ){
+      if( status[i] != 0 ){ continue; }
+      minfcn = found ? std::min( minfcn, fcn[i] ) : fcn[i];
+      found  = true;
+    }
+  }
+
+  TGraph* graph = new TGraph();
+
+  for( size_t i = 0; i < x.size(); ++i ){
+    if( status[i] != 0 ){ continue; }
+    graph->SetPoint( graph->GetN(), x[i], fcn[i]-minfcn );
+  }
+
+  return graph;
+}
+
+
+/**
+ * @brief Fitted value of a function parameter against the scan value, with
+ * the fit uncertainty as the y error, for the converged scan points. The graph
+ * is owned by the caller.
+ */
+TGraph*
+ScanResult::MakeParamGraph( const unsigned ipar ) const
+{
+  TGraphErrors* graph = new TGraphErrors();
+
+  for( size_t i = 0; i < x.size(); ++i ){
+    if( status[i] != 0 ){ continue; }
+    const int n = graph->GetN();
+    graph->SetPoint( n, x[i], param[i].at( ipar ) );
+    graph->SetPointError( n, 0, error[i].at( ipar ) );
+  }
+
+  return graph;
 }
 
 
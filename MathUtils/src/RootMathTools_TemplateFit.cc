@@ -18,7 +18,9 @@
 
 #include "Math/Functor.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 
 namespace usr
 {
@@ -26,35 +28,93 @@ namespace usr
 /**
  * @class TemplateFit
  *
+ * Two objective functions are available for the fit:
  *
+ * - TemplateFit::CHI2 (default): A chi-square like sum of the difference
+ *   between the target histogram and the stacked templates, relative to the
+ *   asymmetric Poisson uncertainty of the target bin.
+ * - TemplateFit::BBLITE: The binned Poisson negative log-likelihood with the
+ *   Barlow--Beeston-lite treatment of the template statistical uncertainties.
+ *   For each bin, a single nuisance parameter \f$\beta_b\f$ scales the total
+ *   prediction \f$\mu_b = \sum_k x_k t_{kb}\f$, constrained by a Gaussian
+ *   with the relative statistical uncertainty of the prediction,
+ *   \f$\sigma_b^2 = \sum_k x_k^2 \delta_{kb}^2 / \mu_b^2\f$, where
+ *   \f$\delta_{kb}\f$ is the uncertainty of template \f$k\f$ in bin \f$b\f$:
+ *   \f[
+ *     \mathrm{NLL} = \sum_b \beta_b\mu_b - n_b
+ *     + n_b \ln\frac{n_b}{\beta_b\mu_b}
+ *     + \frac{(\beta_b-1)^2}{2\sigma_b^2}
+ *   \f]
+ *   The nuisance parameters are solved analytically at each evaluation as the
+ *   positive root of
+ *   \f$\beta^2 + (\mu\sigma^2-1)\beta - n\sigma^2 = 0\f$. As the
+ *   \f$\beta_b\f$ are at their minimum, they do not contribute to the
+ *   gradient with respect to the fit parameters, though the dependence of
+ *   \f$\sigma_b\f$ on the fit parameters does.
+ *
+ * Both objective functions provide analytic gradients, so that the minimizer
+ * does not need to estimate the gradient numerically.
  */
 
 /**
  * @brief Construct a new Template Fit:: Template Fit object
  *
+ * None of the histogram contents, uncertainties or normalizations depend on
+ * the fit parameters, so everything required by the DoEval method is extracted
+ * once here into flat arrays:
+ *
+ * - The target bin content (normalized to unit integral if requested), and
+ *   the inverse of the upper and lower Poisson uncertainties (using
+ *   usr::Poisson::CMSStatCom on the effective number of events in the bin).
+ * - The constituent bin contents normalized to unit integral, stored bin-major
+ *   such that the constituents of a single bin are contiguous in memory.
+ *
+ * For the TemplateFit::BBLITE objective, the raw target content and the
+ * squared uncertainties of the normalized constituent bin contents (in the
+ * same layout as the constituent bin contents) are also stored, such that
+ * the uncertainty of the prediction can be evaluated for the fit parameters.
+ *
+ * The histograms are not referenced after construction for the fit
+ * evaluation, so modifying the histograms after constructing the TemplateFit
+ * instance will not alter the fit results.
+ *
  * @param target_
  * @param constituents_
  * @param normalize_target_
+ * @param obj_
  */
 
 TemplateFit::TemplateFit( const TH1*               target_,
                           const std::vector<TH1*>& constituents_,
-                          const bool               normalize_target_ ) :
+                          const bool               normalize_target_,
+                          const objective          obj_ ) :
   target          ( target_ ),
   constituents    ( constituents_ ),
-  normalize_target( normalize_target_ )
-{}
-
-
-double
-TemplateFit::DoEval( const double*x ) const
+  normalize_target( normalize_target_ ),
+  _objective      ( obj_ ),
+  _nbins          ( target_->GetNcells() ),
+  _ncomp          ( constituents_.size() ),
+  _target_integral( target_->Integral() ),
+  _target_cen     ( _nbins, 0.0 ),
+  _target_invup   ( _nbins, 0.0 ),
+  _target_invlo   ( _nbins, 0.0 ),
+  _template       ( _nbins * _ncomp, 0.0 ),
+  _target_count   ( _nbins, 0.0 ),
+  _bb_err2        ( _nbins * _ncomp, 0.0 ),
+  _bb_active      ( _nbins, 0 )
 {
-  double chi2 = 0;
+  std::vector<double> comp_integral;
+
+  for( const auto& comp : constituents ){
+    comp_integral.push_back( comp->Integral() );
+  }
 
-  for( int bin = 1; bin <= target->GetNcells(); ++bin ){
-    // Getting the target histograms, with upper and lower uncertainties
+  // Bin index runs from 1 to GetNcells() to keep in line with the original
+  // evaluation loop.
+  for( unsigned i = 0; i < _nbins; ++i ){
+    const int    bin = i+1;
     const double cen = normalize_target ?
-                       target->GetBinContent( bin ) / target->Integral() :
+                       target->GetBinContent( bin ) / _target_integral :
                        target->GetBinContent( bin );
 
     const double eff_num = usr::GetEffectiveEvents( *target, bin );
@@ -62,50 +122,241 @@ TemplateFit::DoEval( const double*x ) const
                            1.0 :
                            ( cen / eff_num );
 
-    // Avoid scaling by NAN
-
     const usr::Measurement binerr = usr::Poisson::CMSStatCom( eff_num )
                                     * scale;
     assert( cen == cen );
 
+    _target_cen[i]   = cen;
+    _target_invup[i] = 1.0 / binerr.AbsUpperError();
+    _target_invlo[i] = 1.0 / binerr.AbsLowerError();
+
+    double sum = 0;
+
+    for( unsigned j = 0; j < _ncomp; ++j ){
+      const TH1*   comp = constituents.at( j );
+      const double err  = comp->GetBinError( bin ) / comp_integral.at( j );
+      _template[i * _ncomp+j] = comp->GetBinContent( bin )
+                                / comp_integral.at( j );
+      _bb_err2[i * _ncomp+j] = err * err;
+      sum                   += comp->GetBinContent( bin );
+    }
+
+    _target_count[i] = target->GetBinContent( bin );
+    _bb_active[i]    = sum > 0;
+  }
+}
+
+
+/**
+ * @brief Evaluating the objective function, see the class description for
+ * details.
+ */
+double
+TemplateFit::DoEval( const double*x ) const
+{
+  return _objective == BBLITE ?
+         EvalBBLite( x, nullptr ) :
+         EvalChi2( x, nullptr );
+}
+
+
+/**
+ * @brief Evaluating the full gradient of the objective function in a single
+ * pass over the bins.
+ */
+void
+TemplateFit::Gradient( const double* x, double* grad ) const
+{
+  double f;
+  FdF( x, f, grad );
+}
+
+
+/**
+ * @brief Evaluating the objective function and its gradient in a single pass
+ * over the bins.
+ */
+void
+TemplateFit::FdF( const double* x, double& f, double* grad ) const
+{
+  f = _objective == BBLITE ?
+      EvalBBLite( x, grad ) :
+      EvalChi2( x, grad );
+}
+
+
+/**
+ * @brief Single partial derivative of the objective function, required by the
+ * ROOT::Math gradient interface.
+ *
+ * This is computed from the full gradient, the Gradient and FdF methods should
+ * be used by the minimizers whenever possible.
+ */
+double
+TemplateFit::DoDerivative( const double* x, unsigned icoord ) const
+{
+  std::vector<double> grad( NDim(), 0.0 );
+  Gradient( x, grad.data() );
+  return grad.at( icoord );
+}
+
+
+/**
+ * @brief Chi-square like objective function. Only the cached flat arrays are
+ * used, so the evaluation is a simple allocation-free dot-product loop over the
+ * bins. The gradient is filled if a non-null pointer is provided.
+ */
+double
+TemplateFit::EvalChi2( const double* x, double* grad ) const
+{
+  const unsigned ndim = NDim();
+  double         chi2 = 0;
+
+  if( grad ){ std::fill( grad, grad+ndim, 0.0 ); }
+
+  for( unsigned i = 0; i < _nbins; ++i ){
+    const double  cen  = _target_cen[i];
+    const double* temp = _template.data()+i * _ncomp;
+
     // Summing constituent histograms
     double diff   = 0;
     double valsum = 0;
 
-    for( unsigned index = 0; index < constituents.size(); ++index ){
-      if( !normalize_target || index < constituents.size()-1  ){
-        diff += x[index] * constituents.at( index )->GetBinContent( bin )
-                / constituents.at( index )->Integral();
+    for( unsigned index = 0; index < _ncomp; ++index ){
+      if( !normalize_target || index < _ncomp-1  ){
+        diff   += x[index] * temp[index];
         valsum += x[index];
       } else {
-        diff += ( 1.0-valsum ) * constituents.at( index )->GetBinContent( bin )
-                / constituents.at( index )->Integral();
+        diff += ( 1.0-valsum ) * temp[index];
       }
-      assert( diff == diff );
     }
 
-    // Calculating the different relative to the Poisson error
-    if( diff > cen ){
-      diff = ( diff-cen ) / binerr.AbsUpperError();
-    } else if( diff == cen ){
-      diff = 0.0;
-    } else {
-      diff = ( cen-diff ) / binerr.AbsLowerError();
-    }
+    assert( diff == diff );
+
+    // Calculating the different relative to the Poisson error, keeping the
+    // sign for the gradient calculation.
+    const double inverr = diff > cen ?
+                          _target_invup[i] :
+                          _target_invlo[i];
+    const double res = diff == cen ?
+                       0.0 :
+                       ( diff-cen ) * inverr;
 
     // NAN error
-    if( diff != diff ){
+    if( res != res ){
       continue;
     }
 
-    chi2 += diff * diff;
+    chi2 += res * res;
+
+    if( grad && res != 0 ){
+      const double w = 2 * res * inverr;
+
+      for( unsigned index = 0; index < ndim; ++index ){
+        grad[index] += w * ( normalize_target ?
+                             temp[index]-temp[_ncomp-1] :
+                             temp[index] );
+      }
+    }
   }
 
-  // TODO : Add extended log-likelihood part for normalized fits
   return chi2;
 }
 
 
+/**
+ * @brief Binned Poisson negative log-likelihood with the Barlow--Beeston-lite
+ * per-bin nuisance parameters solved analytically. The gradient is filled if a
+ * non-null pointer is provided.
+ *
+ * The saturated likelihood is subtracted from the per-bin terms, so that the
+ * return value is comparable to half of a chi-square value. The relative
+ * uncertainty of the prediction is evaluated from the per-constituent
+ * uncertainties weighted by the fit parameters, so it contributes to the
+ * gradient through \f$\partial\mathrm{NLL}/\partial\sigma^2 =
+ * -(\beta-1)^2/(2\sigma^4)\f$.
+ */
+double
+TemplateFit::EvalBBLite( const double* x, double* grad ) const
+{
+  static const double minpred = 1e-12;
+
+  const unsigned ndim  = NDim();
+  const double   scale = normalize_target ? _target_integral : 1.0;
+  double         nll   = 0;
+
+  if( grad ){ std::fill( grad, grad+ndim, 0.0 ); }
+
+  for( unsigned i = 0; i < _nbins; ++i ){
+    if( !_bb_active[i] ){ continue; }
+
+    const double  n    = _target_count[i];
+    const double* temp = _template.data()+i * _ncomp;
+    const double* err2 = _bb_err2.data()+i * _ncomp;
+
+    // Summing constituent histograms, and the variance of the sum.
+    double pred   = 0;
+    double var    = 0;
+    double valsum = 0;
+
+    for( unsigned index = 0; index < _ncomp; ++index ){
+      const double c = !normalize_target || index < _ncomp-1 ?
+                       x[index] :
+                       1.0-valsum;
+      pred += c * temp[index];
+      var  += c * c * err2[index];
+      if( index < ndim ){ valsum += x[index]; }
+    }
+
+    const double mu = std::max( scale * pred, minpred );
+    const double s2 = pred > minpred ? var / ( pred * pred ) : 0;
+
+    // Analytic solution of the nuisance parameter, using the numerically
+    // stable form of the quadratic root.
+    double beta = 1.0;
+    if( s2 > 0 ){
+      const double b    = mu * s2-1;
+      const double disc = std::sqrt( b * b+4 * n * s2 );
+      beta = b > 0 ?
+             2 * n * s2 / ( b+disc ) :
+             ( disc-b ) / 2;
+    }
+
+    const double nu = std::max( beta * mu, minpred );
+
+    nll += nu-n;
+    if( n > 0 ){
+      nll += n * std::log( n / nu );
+    }
+    if( s2 > 0 ){
+      nll += ( beta-1 ) * ( beta-1 ) / ( 2 * s2 );
+    }
+
+    if( grad ){
+      // Derivatives with respect to the constituent coefficient c_k:
+      //   dNLL/dc_k = w * t_k + ws * ( 2 c_k d_k^2 - 2 var t_k / pred ) / pred^2
+      const double w  = ( beta-n / mu ) * scale;
+      const double ws = s2 > 0 ?
+                        -( beta-1 ) * ( beta-1 ) / ( 2 * s2 * s2 )
+                        / ( pred * pred ) :
+                        0;
+      auto dc = [&]( const unsigned k, const double c ){
+                  return w * temp[k]
+                         +ws * 2 * ( c * err2[k]-var * temp[k] / pred );
+                };
+      const double clast = normalize_target ? 1.0-valsum : 0;
+      const double dlast = normalize_target ? dc( _ncomp-1, clast ) : 0;
+
+      for( unsigned index = 0; index < ndim; ++index ){
+        grad[index] += dc( index, x[index] )-dlast;
+      }
+    }
+  }
+
+  return nll;
+}
+
+
 /**
  * @brief Helper function to initialize a ROOT::Math::Minimizer for fitting
  */
@@ -114,9 +365,13 @@ TemplateFit::InitMinimizer( ROOT::Math::Minimizer& minimizer ) const
 {
   minimizer.SetFunction( *this );
 
+  // Chi-square like function use the 1 unit for 1 sigma uncertainties, while
+  // the negative log-likelihood uses 0.5 units.
+  minimizer.SetErrorDef( _objective == BBLITE ? 0.5 : 1.0 );
+
   // Initializing the parameters
-  const double integral = target->Integral();
-  const double init     = 1.0 / constituents.size();
+  const double integral = _target_integral;
+  const double init     = 1.0 / _ncomp;
 
   // Setting initial value to a flat distribution among constituents
   for( unsigned i = 0; i < NDim(); ++i ){
@@ -134,22 +389,70 @@ TemplateFit::InitMinimizer( ROOT::Math::Minimizer& minimizer ) const
 }
 
 
+/**
+ * @brief Expected (unnormalized) content of the target histogram bins for a
+ * given set of fit parameters.
+ *
+ * The returned vector is indexed such that element `i` corresponds to bin
+ * `i+1` of the target histogram, following the bin indexing used in the
+ * constructor. If the target histogram is normalized, the prediction is
+ * scaled back to the target histogram integral.
+ */
+std::vector<double>
+TemplateFit::Prediction( const double* x ) const
+{
+  const double        scale = normalize_target ? _target_integral : 1.0;
+  std::vector<double> ans( _nbins, 0.0 );
+
+  for( unsigned i = 0; i < _nbins; ++i ){
+    const double* temp   = _template.data()+i * _ncomp;
+    double        valsum = 0;
+
+    for( unsigned index = 0; index < _ncomp; ++index ){
+      if( !normalize_target || index < _ncomp-1  ){
+        ans[i] += x[index] * temp[index];
+        valsum += x[index];
+      } else {
+        ans[i] += ( 1.0-valsum ) * temp[index];
+      }
+    }
+
+    ans[i] *= scale;
+  }
+
+  return ans;
+}
+
+
+/**
+ * @brief Creating a new TemplateFit instance with the same constituents and
+ * fit settings, but using a different target histogram (such as a
+ * pseudo-experiment histogram).
+ */
+TemplateFit
+TemplateFit::ReplaceTarget( const TH1* newtarget ) const
+{
+  return TemplateFit( newtarget, constituents, normalize_target, _objective );
+}
+
+
 unsigned
 TemplateFit::NDim() const
 {
   return normalize_target ?
-         constituents.size()-1 :
-         constituents.size();
+         _ncomp-1 :
+         _ncomp;
 }
 
 
 std::vector<Measurement>
 TemplateFit::SimpleFit( const TH1*               target,
                         const std::vector<TH1*>& constituents,
-                        const bool               norm )
+                        const bool               norm,
+                        const objective          obj )
 {
   DefaultMinimizer minimizer;
-  TemplateFit      fit( target, constituents, norm );
+  TemplateFit      fit( target, constituents, norm, obj );
 
   fit.InitMinimizer( minimizer );
 
@@ -0,0 +1,435 @@
+/**
+ * @file    ToyStudy.cc
+ * @brief   Implementation of the pseudo-experiment study routines
+ * @author  [Yi-Mu "Enoch" Chen](https://github.com/yimuchen)
+ */
+#ifdef CMSSW_GIT_HASH
+#include "UserUtils/Common/interface/RootUtils/RooArgContainer.hpp"
+#include "UserUtils/Common/interface/STLUtils/StringUtils.hpp"
+#include "UserUtils/Common/interface/SystemUtils/Thread.hpp"
+#include "UserUtils/MathUtils/interface/Measurement/CommonDistro.hpp"
+#include "UserUtils/MathUtils/interface/ToyStudy.hpp"
+#else
+#include "UserUtils/Common/RootUtils/RooArgContainer.hpp"
+#include "UserUtils/Common/STLUtils/StringUtils.hpp"
+#include "UserUtils/Common/SystemUtils/Thread.hpp"
+#include "UserUtils/MathUtils/Measurement/CommonDistro.hpp"
+#include "UserUtils/MathUtils/ToyStudy.hpp"
+#endif
+
+#include <RooDataSet.h>
+#include <RooFitResult.h>
+#include <RooRandom.h>
+#include <RooRealVar.h>
+
+#include "Math/Factory.h"
+#include "Math/Minimizer.h"
+#include "TRandom3.h"
+#include "TROOT.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+namespace usr
+{
+
+/**
+ * @class ToyStudyResult
+ * @details
+ * Stores the fitted value and the upper/lower uncertainties of each parameter
+ * for each toy, together with the fit status of each toy. A toy is considered
+ * converged if the fit status is 0. The pull of a parameter is defined using
+ * the uncertainty facing the true value:
+ * \f[
+ *   \mathrm{pull} = \frac{\hat{\theta} - \theta_\mathrm{true}}
+ *                        {\sigma_{\pm}}
+ * \f]
+ * where the upper uncertainty is used if the fitted value is below the true
+ * value, and the lower uncertainty otherwise.
+ */
+ToyStudyResult::ToyStudyResult( const std::vector<std::string>& names,
+                                const std::vector<double>&      truth,
+                                const unsigned                  ntoys ) :
+  _names ( names ),
+  _truth ( truth ),
+  _value ( ntoys * names.size(), 0.0 ),
+  _errup ( ntoys * names.size(), 0.0 ),
+  _errlo ( ntoys * names.size(), 0.0 ),
+  _status( ntoys, -1 )
+{}
+
+
+/**
+ * @brief Number of toys with a fit status of 0.
+ */
+unsigned
+ToyStudyResult::NConverged() const
+{
+  return std::count( _status.begin(), _status.end(), 0 );
+}
+
+
+const std::string&
+ToyStudyResult::Name( const unsigned i ) const
+{ return _names.at( i ); }
+
+double
+ToyStudyResult::Truth( const unsigned i ) const
+{ return _truth.at( i ); }
+
+double
+ToyStudyResult::Value( const unsigned toy, const unsigned i ) const
+{ return _value.at( toy * NParam()+i ); }
+
+double
+ToyStudyResult::UpperError( const unsigned toy, const unsigned i ) const
+{ return _errup.at( toy * NParam()+i ); }
+
+double
+ToyStudyResult::LowerError( const unsigned toy, const unsigned i ) const
+{ return _errlo.at( toy * NParam()+i ); }
+
+int
+ToyStudyResult::Status( const unsigned toy ) const
+{ return _status.at( toy ); }
+
+
+/**
+ * @brief Pull of a parameter in a toy, see class description for the
+ * definition.
+ */
+double
+ToyStudyResult::Pull( const unsigned toy, const unsigned i ) const
+{
+  const double diff = Value( toy, i )-Truth( i );
+  const double err  = diff < 0 ?
+                      UpperError( toy, i ) :
+                      LowerError( toy, i );
+  return err > 0 ? diff / err : 0;
+}
+
+
+/**
+ * @brief Fraction of converged toys where the true value is contained in the
+ * fitted uncertainty interval, with the Clopper--Pearson interval as the
+ * uncertainty.
+ */
+Measurement
+ToyStudyResult::Coverage( const unsigned i ) const
+{
+  unsigned ncover = 0;
+
+  for( unsigned t = 0; t < NToys(); ++t ){
+    if( Status( t ) != 0 ){ continue; }
+    if( Value( t, i )-LowerError( t, i ) <= Truth( i ) &&
+        Truth( i ) <= Value( t, i )+UpperError( t, i ) ){
+      ++ncover;
+    }
+  }
+
+  return Efficiency::ClopperPearson( ncover, NConverged() );
+}
+
+
+/**
+ * @brief Histogram of the pulls of a parameter for the converged toys. The
+ * histogram is owned by the caller.
+ */
+TH1D*
+ToyStudyResult::MakePullHist( const unsigned i,
+                              const unsigned nbins,
+                              const double   min,
+                              const double   max ) const
+{
+  TH1D* hist = new TH1D( usr::RandomString( 6 ).c_str(),
+                         ( ";Pull(" + Name( i ) + ");Toys" ).c_str(),
+                         nbins, min, max );
+
+  for( unsigned t = 0; t < NToys(); ++t ){
+    if( Status( t ) != 0 ){ continue; }
+    hist->Fill( Pull( t, i ) );
+  }
+
+  return hist;
+}
+
+
+/**
+ * @brief Histogram of the fitted values of a parameter for the converged
+ * toys. The histogram range is set to contain all fitted values. The histogram
+ * is owned by the caller.
+ */
+TH1D*
+ToyStudyResult::MakeValueHist( const unsigned i, const unsigned nbins ) const
+{
+  double min = Truth( i );
+  double max = Truth( i );
+
+  for( unsigned t = 0; t < NToys(); ++t ){
+    if( Status( t ) != 0 ){ continue; }
+    min = std::min( min, Value( t, i ) );
+    max = std::max( max, Value( t, i ) );
+  }
+
+  const double pad = min == max ?
+                     1.0 :
+                     0.05 * ( max-min );
+
+  TH1D* hist = new TH1D( usr::RandomString( 6 ).c_str(),
+                         ( ";" + Name( i ) + ";Toys" ).c_str(),
+                         nbins, min-pad, max+pad );
+
+  for( unsigned t = 0; t < NToys(); ++t ){
+    if( Status( t ) != 0 ){ continue; }
+    hist->Fill( Value( t, i ) );
+  }
+
+  return hist;
+}
+
+
+void
+ToyStudyResult::SetStatus( const unsigned toy, const int status )
+{ _status.at( toy ) = status; }
+
+void
+ToyStudyResult::SetResult( const unsigned toy,
+                           const unsigned i,
+                           const double   value,
+                           const double   errup,
+                           const double   errlo )
+{
+  _value.at( toy * NParam()+i ) = value;
+  _errup.at( toy * NParam()+i ) = errup;
+  _errlo.at( toy * NParam()+i ) = errlo;
+}
+
+
+/*-----------------------------------------------------------------------------
+ *  Toy study routines
+   --------------------------------------------------------------------------*/
+
+/**
+ * @brief Saving the state of the global RooFit random number generator on
+ * construction, and restoring it on destruction.
+ *
+ * The state can only be saved if the generator is a TRandom3 instance (the
+ * RooFit default).
+ */
+namespace
+{
+
+struct RooRandomStateGuard
+{
+  TRandom3* gen;
+  TRandom3  saved;
+
+  RooRandomStateGuard() :
+    gen( dynamic_cast<TRandom3*>( RooRandom::randomGenerator() ) )
+  {
+    if( gen ){ saved = *gen; }
+  }
+
+  ~RooRandomStateGuard()
+  {
+    if( gen ){ *gen = saved; }
+  }
+};
+
+}
+
+
+/**
+ * @brief Running a pseudo-experiment study of a RooFit PDF.
+ *
+ * The true values are the present values of the floating parameters of the
+ * PDF. Each toy data set is generated from the original PDF, then fitted by a
+ * clone of the PDF with the parameters reset to the true values, so the
+ * original PDF is never modified. The RooFit generation routines use the
+ * global RooFit random number generator, which is reseeded for each toy, and
+ * its state is restored once the study is completed. RooFit keeps
+ * process-wide states that are not protected against concurrent fits, so the
+ * toys are processed one after another in the calling thread. Each toy data
+ * set is deleted after the fit.
+ *
+ * The following options are accepted:
+ * - `usr::NumToys( n, seed )`: number of toys (default 1000) and the random
+ *   seed.
+ * - `RooFit::NumEvents( n )`: number of events per toy, defaults to the
+ *   expected number of events of the PDF.
+ * - `RooFit::Extended()`: fluctuating the number of events per toy, this is
+ *   also passed to the fit.
+ *
+ * All other arguments are passed to the fit routine usr::FitPDFToData.
+ */
+ToyStudyResult
+RunToyStudy( RooAbsPdf&                    pdf,
+             const RooArgSet&              observables,
+             const std::vector<RooCmdArg>& cmdargs )
+{
+  const RooArgContainer args( cmdargs, { NumToys( 1000 ), RooFit::Save() } );
+  const unsigned        ntoys   = std::max( args.GetInt( "NumToys", 0 ), 1 );
+  const unsigned        seed    = args.GetInt( "NumToys", 1 );
+  const int nevents = args.Has( "NumEvents" ) ?
+                      args.GetInt( "NumEvents" ) :
+                      std::lround( pdf.expectedEvents( observables ) );
+  const bool extended = args.Has( "Extended" ) && args.GetInt( "Extended" );
+
+  std::vector<RooCmdArg> fitargs;
+
+  for( const auto& arg : args ){
+    if( std::string( arg.GetName() ) != "NumEvents" ){
+      fitargs.push_back( arg );
+    }
+  }
+
+  // Getting the floating parameters as the true values
+  std::unique_ptr<RooArgSet> params( pdf.getParameters( observables ) );
+  std::unique_ptr<RooArgSet> init( (RooArgSet*)params->snapshot() );
+  std::vector<std::string>   names;
+  std::vector<double>        truth;
+
+  for( const auto arg : *params ){
+    const RooRealVar* var = dynamic_cast<const RooRealVar*>( arg );
+    if( var && !var->isConstant() ){
+      names.push_back( var->GetName() );
+      truth.push_back( var->getVal() );
+    }
+  }
+
+  ToyStudyResult result( names, truth, ntoys );
+
+  // The fits are performed on a clone of the PDF.
+  std::unique_ptr<RooAbsPdf> pdfclone(
+    static_cast<RooAbsPdf*>( pdf.cloneTree() ) );
+  std::unique_ptr<RooArgSet> paramclone(
+    pdfclone->getParameters( observables ) );
+
+  RooRandomStateGuard randguard;
+
+  for( size_t t = 0; t < ntoys; ++t ){
+    RooRandom::randomGenerator()->SetSeed( seed * ntoys+t+1 );
+    std::unique_ptr<RooDataSet> toy(
+      pdf.generate( observables,
+                    RooFit::NumEvents( nevents ),
+                    RooFit::Extended( extended ) ) );
+
+    if( !toy ){ continue; }
+
+    paramclone->assignValueOnly( *init );
+    std::unique_ptr<RooFitResult> fit(
+      FitPDFToData( *pdfclone, *toy, fitargs ) );
+
+    result.SetStatus( t, fit->status() );
+
+    for( unsigned i = 0; i < names.size(); ++i ){
+      const RooRealVar* var = dynamic_cast<const RooRealVar*>(
+        fit->floatParsFinal().find( names[i].c_str() ) );
+      if( !var ){ continue; }
+      if( var->hasAsymError() ){
+        result.SetResult( t, i, var->getVal(),
+                          var->getAsymErrorHi(), -var->getAsymErrorLo() );
+      } else {
+        result.SetResult( t, i, var->getVal(),
+                          var->getError(), var->getError() );
+      }
+    }
+  }
+
+  return result;
+}
+
+
+/**
+ * @brief Running a pseudo-experiment study of a histogram template fit.
+ *
+ * The true values should be given in the same format as the fit parameters
+ * of the template fit. The expected content of each bin is computed using the
+ * TemplateFit::Prediction method, and the content of the toy target histogram
+ * is generated by Poisson fluctuations of the expected content. The
+ * constituent histograms are not fluctuated.
+ *
+ * Each worker thread owns a copy of the target histogram and a Minuit2
+ * minimizer instance, which are reused for every toy (TMinuit used by the
+ * usr::DefaultMinimizer is not re-entrant). The parameter uncertainties are
+ * the symmetric uncertainties obtained from the Hessian matrix. The
+ * `usr::NumToys` and `usr::NumThreads` options are accepted.
+ */
+ToyStudyResult
+RunToyStudy( const TemplateFit&            model,
+             const std::vector<double>&    truth,
+             const std::vector<RooCmdArg>& cmdargs )
+{
+  const RooArgContainer args( cmdargs, { NumToys( 1000 ) } );
+  const unsigned        ntoys   = std::max( args.GetInt( "NumToys", 0 ), 1 );
+  const unsigned        seed    = args.GetInt( "NumToys", 1 );
+  const unsigned        nthread = args.Has( "NumThreads" ) ?
+                                  args.GetInt( "NumThreads" ) :
+                                  0;
+
+  if( truth.size() != model.NDim() ){
+    throw std::invalid_argument(
+            "Number of true values doesn't match the template fit parameters" );
+  }
+
+  std::vector<std::string> names;
+
+  for( unsigned i = 0; i < model.NDim(); ++i ){
+    names.push_back( "x" + std::to_string( i ) );
+  }
+
+  ToyStudyResult            result( names, truth, ntoys );
+  const std::vector<double> expected = model.Prediction( truth.data() );
+  const int                 ncells   = model.Target()->GetNcells();
+
+  // Creating the per-worker objects in the calling thread.
+  const unsigned nworkers = usr::WorkerCount( nthread, ntoys );
+  std::vector<std::unique_ptr<TH1> >                   toyhist;
+  std::vector<std::unique_ptr<ROOT::Math::Minimizer> > minimizer;
+
+  if( nworkers > 1 ){
+    ROOT::EnableThreadSafety();
+  }
+
+  for( unsigned w = 0; w < nworkers; ++w ){
+    toyhist.emplace_back( static_cast<TH1*>( model.Target()->Clone() ) );
+    toyhist.back()->SetDirectory( nullptr );
+    minimizer.emplace_back(
+      ROOT::Math::Factory::CreateMinimizer( "Minuit2", "Migrad" ) );
+    minimizer.back()->SetMaxFunctionCalls( 1000000 );
+    minimizer.back()->SetTolerance( 0.00001 );
+    minimizer.back()->SetPrintLevel( -1 );
+  }
+
+  usr::ParallelFor( ntoys, nthread, [&]( const size_t t, const unsigned w ){
+    TRandom3 rand( seed * ntoys+t+1 );
+    TH1&     hist = *toyhist[w];
+    hist.Reset();
+
+    for( unsigned i = 0; i < expected.size() && (int)i+1 < ncells; ++i ){
+      const double n = expected[i] > 0 ? rand.Poisson( expected[i] ) : 0;
+      hist.SetBinContent( i+1, n );
+      hist.SetBinError( i+1, std::sqrt( n ) );
+    }
+
+    const TemplateFit      fit = model.ReplaceTarget( &hist );
+    ROOT::Math::Minimizer& min = *minimizer[w];
+    min.Clear();
+    fit.InitMinimizer( min );
+    min.Minimize();
+
+    const int status = min.Status();
+    min.Hesse();
+    result.SetStatus( t, status );
+
+    for( unsigned i = 0; i < fit.NDim(); ++i ){
+      result.SetResult( t, i, min.X()[i], min.Errors()[i], min.Errors()[i] );
+    }
+  } );
+
+  return result;
+}
+
+}/* usr */
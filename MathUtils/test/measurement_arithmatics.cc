@@ -226,5 +226,31 @@ main( int argc, char const* argv[] )
     cout << fmt::decimal( Prod( b, c, d ), 5 ) << endl;
   }
 
+  cout << separator() << endl
+       << ">>> Trivially copyable container test" << endl;
+  {
+    const vector<MeasurementPOD> list = {
+      MeasurementPOD( Poisson::Minos( 10 ) ),
+      MeasurementPOD( Poisson::Minos( 20 ) ),
+      MeasurementPOD( Poisson::Minos( 30 ) )};
+    MeasurementPOD sum( 0, 0, 0 );
+
+    for( const auto& x : list ){
+      sum += x;
+    }
+
+    cout << fmt::decimal( Measurement( sum ), 5 ) << endl;
+    cout << fmt::decimal( Poisson::Minos( 10 )
+                          +Poisson::Minos( 20 )
+                          +Poisson::Minos( 30 ), 5 ) << endl;
+    cout << fmt::decimal( Measurement( ( list[0] * 2. ).NormParam() ), 5 )
+         << endl;
+
+    // Mixed expressions are evaluated as Measurement arithmetics
+    const Measurement m20 = Poisson::Minos( 20 );
+    cout << fmt::decimal( list[0]+m20, 5 ) << " "
+         << fmt::decimal( m20 * list[2] / list[0]-list[1], 5 ) << endl;
+  }
+
   return 0;
 }
@@ -15,7 +15,10 @@
 #include "RooRealVar.h"
 #include "TRandom3.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <string>
 using namespace std;
 
 int
@@ -58,6 +61,46 @@ main( int argc, char* argv[] )
       << usr::KSDistance( unweighted, g, x, RooFit::CutRange("lower"), RooFit::CutRange("upper") )
   << endl;
 
+  // The tabulated CDF should reproduce the exact KS distance to within the
+  // tabulation tolerance, with and without cut ranges. The KS distance is
+  // scaled by the square root of the number of events, and the CDF difference
+  // is enhanced by the inverse of the range normalization (and the
+  // subtraction of the range edge values) when cut ranges are used.
+  const double tolerance = 1e-6;
+  const double bound     = 4 * tolerance * std::sqrt( double(N) );
+  double       maxdiff   = 0;
+
+  for( const auto& cut : { std::string( "" ), std::string( "center" ),
+                           std::string( "lower,upper" ) } ){
+    const RooCmdArg cutarg = cut == "" ? RooCmdArg::none() :
+                             RooFit::CutRange( cut.c_str() );
+    const double table = usr::KSDistance( unweighted, g, x, cutarg,
+                                          usr::KSTolerance( tolerance ) );
+    const double exact = usr::KSDistance( unweighted, g, x, cutarg,
+                                          usr::KSTolerance( 0 ) );
+
+    cout << "[" << cut << "] " << table << " " << exact << endl;
+    maxdiff = std::max( maxdiff, std::fabs( table-exact ) );
+  }
+
+  if( maxdiff > bound ){
+    cerr << "Tabulated KS distance differs from exact value by "
+         << maxdiff << " (allowed " << bound << ")" << endl;
+    return 1;
+  }
+
+  // Toy based p-values, compared with the asymptotic values
+  cout
+      << usr::KSProb( unweighted, g, x ) << " "
+      << usr::fmt::decimal(
+    usr::KSToyProb( unweighted, g, x, usr::NumToys( 200, 1 ) ), 3 ) << " "
+      << usr::fmt::decimal(
+    usr::KSToyProb( weighted, g, x, usr::NumToys( 200, 1 ),
+                    RooFit::CutRange( "lower,upper" ) ), 3 ) << " "
+      << usr::fmt::decimal(
+    usr::KSToyProb( weighted, unweighted, x, usr::NumToys( 200, 1 ) ), 3 )
+  << endl;
+
 
   return 0;
 }
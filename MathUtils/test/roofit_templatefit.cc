@@ -34,6 +34,8 @@ main()
 
   const auto fit_total = usr::TemplateFit::SimpleFit( &h3, {&h1, &h2}, false );
   const auto fit_frac  = usr::TemplateFit::SimpleFit( &h3, {&h1, &h2}, true );
+  const auto fit_bb    = usr::TemplateFit::SimpleFit( &h3, {&h1, &h2}, false,
+                                                      usr::TemplateFit::BBLITE );
 
 
   std::cout << fit_total.size() << std::endl;
@@ -52,5 +54,13 @@ main()
   }
   std::cout << std::endl;
 
+  std::cout << fit_bb.size() << std::endl;
+  for( const auto p : fit_bb ){
+    std::cout << p.CentralValue() << " "
+              << p.AbsUpperError() << " "
+              << p.AbsLowerError() << std::endl ;
+  }
+  std::cout << std::endl;
+
   return 0;
 }
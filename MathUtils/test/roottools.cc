@@ -5,11 +5,17 @@
  */
 #ifdef CMSSW_GIT_HASH
 #include "UserUtils/MathUtils/interface/RootMathTools/DefaultEngines.hpp"
+#include "UserUtils/MathUtils/interface/RootMathTools/RootFit.hpp"
 #else
 #include "UserUtils/MathUtils/RootMathTools/DefaultEngines.hpp"
+#include "UserUtils/MathUtils/RootMathTools/RootFit.hpp"
 #endif
 
 #include "Math/Functor.h"
+#include "TGraphErrors.h"
+#include "TRandom3.h"
+
+#include <memory>
 
 int
 main()
@@ -23,4 +29,30 @@ main()
 
   std::cout << solver.SolveF( f, -1, 1 ) << std::endl;
   std::cout << solver.SolveForY( f, 0.5, 0, 1 ) << std::endl;
+
+  // Parameter scan of a graph fit
+  TRandom3     rand;
+  TGraphErrors g;
+
+  for( int i = 0; i < 100; ++i ){
+    const double x = i * 0.1;
+    g.SetPoint( i, x, 2 * x+1+rand.Gaus( 0, 0.5 ) );
+    g.SetPointError( i, 0, 0.5 );
+  }
+
+  TF1                 line( "line", "[0]*x+[1]", 0, 10 );
+  std::vector<double> slopes;
+
+  for( int i = 0; i < 41; ++i ){
+    slopes.push_back( 1.9+0.005 * i );
+  }
+
+  line.SetParameters( 2, 1 );
+  const usr::fit::ScanResult scan = usr::fit::ScanGraphParam( g, line, 0,
+                                                              slopes );
+  std::unique_ptr<TGraph> profile( scan.MakeGraph() );
+
+  for( int i = 0; i < profile->GetN(); ++i ){
+    std::cout << profile->GetX()[i] << " " << profile->GetY()[i] << std::endl;
+  }
 }
@@ -0,0 +1,82 @@
+/**
+ * @file    toystudy.cc
+ * @brief   Testing the pseudo-experiment study routines
+ * @author  [Yi-Mu "Enoch" Chen](https://github.com/yimuchen)
+ */
+#ifdef CMSSW_GIT_HASH
+#include "UserUtils/MathUtils/interface/ToyStudy.hpp"
+#else
+#include "UserUtils/MathUtils/ToyStudy.hpp"
+#endif
+
+#include "RooGaussian.h"
+#include "RooRealVar.h"
+#include "TH1D.h"
+#include "TRandom3.h"
+
+#include <iostream>
+#include <memory>
+
+int
+main()
+{
+  // RooFit PDF toys
+  RooRealVar  x( "x", "x", -10, 10 );
+  RooRealVar  m( "m", "m", 0, -5, 5 );
+  RooRealVar  s( "s", "s", 2, 0.1, 5 );
+  RooGaussian g( "g", "g", x, m, s );
+
+  const usr::ToyStudyResult pdfresult = usr::RunToyStudy(
+    g, RooArgSet( x ),
+    usr::NumToys( 200, 1 ),
+    RooFit::NumEvents( 500 ) );
+
+  std::cout << pdfresult.NConverged() << "/" << pdfresult.NToys() << std::endl;
+
+  for( unsigned i = 0; i < pdfresult.NParam(); ++i ){
+    std::unique_ptr<TH1D> pull( pdfresult.MakePullHist( i ) );
+    const usr::Measurement cover = pdfresult.Coverage( i );
+    std::cout << pdfresult.Name( i ) << " "
+              << pull->GetMean() << " "
+              << pull->GetRMS() << " "
+              << cover.CentralValue() << std::endl;
+  }
+
+  std::cout << std::endl;
+
+  // Template fit toys
+  TRandom3 rand;
+
+  TH1D h1( "h1", "", 100, -10, 10 );
+  TH1D h2( "h2", "", 100, -10, 10 );
+  TH1D h3( "h3", "", 100, -10, 10 );
+
+  for( unsigned i = 0; i < 1000000; ++i ){
+    h1.Fill( rand.Gaus( -2, 1 ) );
+    h2.Fill( rand.Gaus( 2, 1.5 ) );
+    if( i% 100 == 0 ){
+      h3.Fill( rand.Gaus( -2, 1 ) );
+    }
+    if( i% 200 == 0 ){
+      h3.Fill( rand.Gaus( 2, 1.5 ) );
+    }
+  }
+
+  const usr::TemplateFit    model( &h3, {&h1, &h2}, false );
+  const usr::ToyStudyResult tempresult = usr::RunToyStudy(
+    model, {10000, 5000}, usr::NumToys( 200, 1 ) );
+
+  std::cout << tempresult.NConverged() << "/" << tempresult.NToys()
+            << std::endl;
+
+  for( unsigned i = 0; i < tempresult.NParam(); ++i ){
+    std::unique_ptr<TH1D> pull( tempresult.MakePullHist( i ) );
+    const usr::Measurement cover = tempresult.Coverage( i );
+    std::cout << tempresult.Name( i ) << " "
+              << pull->GetMean() << " "
+              << pull->GetRMS() << " "
+              << cover.CentralValue() << std::endl;
+  }
+
+  return 0;
+}
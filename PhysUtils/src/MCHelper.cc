@@ -11,6 +11,7 @@
 
 #include <queue>
 #include <stack>
+#include <unordered_set>
 
 namespace usr
 {
@@ -273,15 +274,16 @@ RunBFS( const reco::Candidate*x,
           std::queue<const reco::Candidate*>&,
           const reco::Candidate* ) )
 {
-  std::vector<const reco::Candidate*> ans;
-  std::queue<const reco::Candidate*>  bfs_queue;
+  std::vector<const reco::Candidate*>        ans;
+  std::unordered_set<const reco::Candidate*> found;
+  std::queue<const reco::Candidate*>         bfs_queue;
   bfs_queue.push( x );
 
   while( !bfs_queue.empty() ){
     const reco::Candidate*temp = bfs_queue.front();
     bfs_queue.pop();
 
-    if( is_target( temp, x ) && !usr::FindValue( ans, temp ) ){
+    if( is_target( temp, x ) && found.insert( temp ).second ){
       ans.push_back( temp );
     }
 
@@ -8,12 +8,14 @@
 #include "UserUtils/Common/interface/STLUtils/OStreamUtils.hpp"
 #include "UserUtils/Common/interface/STLUtils/StringUtils.hpp"
 #include "UserUtils/MathUtils/interface/Miscellaneous.hpp"
+#include "UserUtils/MathUtils/interface/RandomUtils.hpp"
 #include "UserUtils/PlotUtils/interface/Pad1D.hpp"
 #else
 #include "UserUtils/Common/Maths.hpp"
 #include "UserUtils/Common/STLUtils/OStreamUtils.hpp"
 #include "UserUtils/Common/STLUtils/StringUtils.hpp"
 #include "UserUtils/MathUtils/Miscellaneous.hpp"
+#include "UserUtils/MathUtils/RandomUtils.hpp"
 #include "UserUtils/PlotUtils/Pad1D.hpp"
 #endif
 
@@ -563,9 +565,15 @@ Pad1D::MakeTF1GraphMatrix( const TF1&         func,
   nsamples *= TMath::Power( TMath::Pi(), double(npar) / 2 );
   nsamples /= TMath::Gamma( double(npar) / 2 );
 
+  // Generating all random directions in a single call
+  const std::vector<double> directions = usr::rng::OnSphere(
+    npar, std::ceil( nsamples ) );
+  TVectorD                  direction( npar );
+
   for( unsigned i = 0 ; i < nsamples ; ++i ){
     // Generating a randomixed shift
-    const TVectorD rshift = shift * usr::RandomOnSphere( npar ) * z;
+    direction.SetElements( directions.data()+i * npar );
+    const TVectorD rshift = shift * direction * z;
 
     // Shifting the paramters
     for( unsigned j = 0 ; j < npar; ++j  ){